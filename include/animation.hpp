@@ -0,0 +1,51 @@
+// include/animation.hpp
+#ifndef ANIMATION_HPP
+#define ANIMATION_HPP
+
+#include "scene.hpp"
+#include <map>
+#include <string>
+#include <vector>
+
+// Quadros-chave (interpolados linearmente entre chaves consecutivas)
+struct CameraKey {
+    int frame = 0;
+    Vec3 eye, lookAt, up;
+    double fovy = 40;
+};
+
+struct LightKey {
+    int frame = 0;
+    Vec3 position;
+    Vec3 color;
+};
+
+struct ObjectKey {
+    int frame = 0;
+    Vec3 offset; // Translação relativa à posição na cena base
+};
+
+// Animação sobre uma cena base
+struct Animation {
+    int firstFrame = 0;
+    int lastFrame = 0;
+
+    std::vector<CameraKey> camera;
+    std::map<int, std::vector<LightKey>> lights;   // Índice da luz -> chaves
+    std::map<int, std::vector<ObjectKey>> objects; // Índice do objeto -> chaves
+};
+
+bool loadAnimation(const std::string& filename, Animation& anim);
+
+// Verificar se os índices da animação existem na cena
+bool checkAnimation(const Animation& anim, const Scene& scene);
+
+// Aplicar o quadro à cena. 'base' guarda a geometria original dos objetos.
+// Retorna true se alguma geometria mudou (a BVH precisa de refit).
+bool applyAnimationFrame(const Animation& anim, int frame,
+                         const std::vector<Object>& base, Scene& scene);
+
+// saida.ppm -> saida_0007.ppm
+std::string frameFileName(const std::string& filename, int frame);
+
+#endif
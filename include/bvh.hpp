@@ -0,0 +1,23 @@
+// include/bvh.hpp
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include "scene.hpp"
+
+// Caixa envolvente de um objeto (inválida se o objeto for ilimitado)
+AABB computeBounds(const Object& obj);
+
+// Construir a BVH da cena a partir do zero
+void buildBVH(Scene& scene);
+
+// Reconstruir a topologia reaproveitando as caixas guardadas na BVH
+void rebuildBVH(Scene& scene);
+
+// Recalcular as caixas mantendo a topologia (objetos apenas transladados).
+// Só as caixas dos objetos em 'changed' são refeitas; as demais vêm da BVH.
+void refitBVH(Scene& scene, const std::vector<int>& changed);
+
+// Teste raio-caixa pelo método dos slabs
+bool intersectAABB(const Ray& ray, const Vec3& invDir, const AABB& box, Real tMax);
+
+#endif
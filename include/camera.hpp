@@ -0,0 +1,28 @@
+// include/camera.hpp
+#ifndef CAMERA_HPP
+#define CAMERA_HPP
+
+#include "scene.hpp"
+#include <string>
+#include <vector>
+
+// Vista completa: posição, orientação, abertura e foco
+struct Camera {
+    Vec3 eye;
+    Vec3 lookAt;
+    Vec3 up;
+    double fovy = 40.0;
+    double aperture = 0.0;
+    double focusDist = 10.0;
+};
+
+// Câmera definida no arquivo de cena, com os parâmetros de DOF dados
+Camera sceneCamera(const Scene& scene, double aperture, double focusDist);
+
+// Lista de câmeras (.cams), uma por linha:
+//   camera ex ey ez  lx ly lz  ux uy uz  fovy  [abertura foco]
+// Sem abertura/foco usa os valores padrão informados.
+bool loadCameras(const std::string& filename, double aperture, double focusDist,
+                 std::vector<Camera>& cameras);
+
+#endif
@@ -0,0 +1,31 @@
+// include/denoise.hpp
+#ifndef DENOISE_HPP
+#define DENOISE_HPP
+
+#include <vector>
+
+// Buffers auxiliares do primeiro impacto (médias por pixel, planos separados)
+struct AuxBuffers {
+    int width = 0, height = 0;
+    std::vector<float> albedo[3];  // Cor do pigmento
+    std::vector<float> normal[3];
+    std::vector<float> depth;      // Distância até o impacto primário
+    std::vector<float> variance;   // Variância da média (luminância) entre amostras
+
+    void resize(int w, int h);
+};
+
+struct DenoiseParams {
+    int iterations = 5;        // Passos à-trous (raio efetivo 2^iterations)
+    float sigmaColor = 4.0f;   // Tolerância de cor em desvios-padrão do ruído
+    float sigmaNormal = 0.5f;  // Tolerância em 1 - n·n'
+    float sigmaDepth = 0.05f;  // Tolerância relativa de profundidade
+    float sigmaAlbedo = 1.0f;  // Frouxa: com poucas amostras o albedo também é ruidoso
+};
+
+// Filtro à-trous guiado por albedo, normal e profundidade (Dammertz et al.),
+// com a tolerância de cor escalada pela variância estimada (como no SVGF).
+// 'color' são três planos RGB lineares (w*h cada), filtrados no lugar.
+void denoise(std::vector<float> color[3], const AuxBuffers& aux, const DenoiseParams& params);
+
+#endif
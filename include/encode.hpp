@@ -0,0 +1,61 @@
+// include/encode.hpp
+#ifndef ENCODE_HPP
+#define ENCODE_HPP
+
+#include "image.hpp"
+#include "tonemap.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Formato de saída escolhido pela extensão do arquivo
+enum ImageFormat { IMAGE_PPM, IMAGE_QOI, IMAGE_PNG };
+
+// .qoi e .png (sem diferenciar maiúsculas); qualquer outra extensão é PPM
+ImageFormat imageFormatFor(const std::string& filename);
+
+// Codificador comprimido por faixas de linhas. Cada faixa é convertida para
+// 8 bits e codificada sem depender das outras (QOI recomeça com um pixel
+// explícito; PNG tem seu próprio IDAT, terminado em sync flush do deflate),
+// então as faixas podem ser codificadas em qualquer thread e ordem, inclusive
+// durante a renderização, assim que suas linhas ficam prontas.
+class ImageEncoder {
+private:
+    const HDRImage& image;     // Lida apenas ao codificar cada faixa
+    int width, height;
+    ImageFormat format;
+    ToneMap op;
+    double gamma;
+    int bandRows;
+    int bandCount;
+
+    std::vector<std::vector<unsigned char>> bands;   // Bytes codificados de cada faixa
+    std::vector<uint32_t> adlers;                    // Adler-32 dos dados da faixa (PNG)
+    std::unique_ptr<std::atomic<int>[]> pendingRows; // Linhas ainda não prontas
+    std::unique_ptr<std::atomic<bool>[]> claimed;
+
+    void encodeBand(int band);
+    void claimBand(int band);
+
+public:
+    // 'image' pode ainda não ter o tamanho final: só é lida nas faixas prontas
+    ImageEncoder(const HDRImage& image, int width, int height, ImageFormat format,
+                 ToneMap op, double gamma, int bandRows = 32);
+
+    ImageEncoder(const ImageEncoder&) = delete;
+    ImageEncoder& operator=(const ImageEncoder&) = delete;
+
+    // Linhas [y0, y1) finais: faixas completas são codificadas na thread chamadora
+    void rowsReady(int y0, int y1);
+
+    // Codificar em paralelo as faixas restantes e montar o arquivo
+    std::vector<unsigned char> finish();
+    bool save(const std::string& filename);
+};
+
+// Salvar no formato da extensão (PPM continua em texto P3)
+bool writeImage(const std::string& filename, const HDRImage& image, ToneMap op, double gamma);
+
+#endif
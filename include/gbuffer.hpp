@@ -0,0 +1,73 @@
+// include/gbuffer.hpp
+#ifndef GBUFFER_HPP
+#define GBUFFER_HPP
+
+#include "scene.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+constexpr int GNODE_NONE = -1;       // Sem contribuição (recursão esgotada, reflexão total interna)
+constexpr int GNODE_BACKGROUND = -2; // Raio escapou da cena: cor de fundo
+constexpr int GBUFFER_MAX_LIGHTS = 64;
+
+// Acima disso (estimado antes de renderizar) o G-buffer é desativado
+constexpr size_t GBUFFER_MAX_BYTES = size_t(1) << 30;
+
+// Ponto de sombreamento gravado (visibilidade já resolvida)
+struct GBufferNode {
+    Vec3 point;
+    Vec3 normal;
+    Vec3 viewDir;
+    Vec3 baseColor;             // Cor do pigmento no ponto
+    int objectIdx = -1;
+    uint64_t shadowMask = 0;    // Bit i: luz i ocluída
+    int reflectChild = GNODE_NONE;
+    int refractChild = GNODE_NONE;
+};
+
+// Gravação de um pixel em andamento: árvores de raios de todas as amostras.
+// Rascunho reaproveitado por thread; o resultado vai para o GBuffer do quadro.
+struct GBufferPixel {
+    std::vector<GBufferNode> nodes;
+    std::vector<int> roots;     // Nó atingido pelo raio primário de cada amostra
+    int lastNode = GNODE_NONE;  // Nó do último raio traçado (usado na gravação)
+
+    void clear() {
+        nodes.clear();
+        roots.clear();
+        lastNode = GNODE_NONE;
+    }
+};
+
+// G-buffer do quadro: nós de todos os pixels num único vetor, sem alocações
+// por pixel. Filhos e raízes são índices relativos ao primeiro nó do pixel.
+class GBuffer {
+private:
+    int samples = 0;
+    std::vector<GBufferNode> nodes;
+    std::vector<size_t> first;  // Primeiro nó de cada pixel
+    std::vector<int> roots;     // 'samples' raízes por pixel
+    std::mutex mutex;           // Só para acrescentar nós (store)
+
+public:
+    // Bytes ocupados por 'nodeCount' nós em 'pixels' pixels
+    static size_t bytes(size_t pixels, int samples, size_t nodeCount);
+
+    // Preparar para um quadro; 'expectedNodes' é reservado de uma vez
+    void reset(size_t pixels, int samples, size_t expectedNodes);
+    void clear();
+    bool empty() const { return first.empty(); }
+    int sampleCount() const { return samples; }
+
+    // Guardar as árvores gravadas de um pixel (chamado em paralelo). Gravar
+    // o mesmo pixel de novo (retraço) deixa os nós antigos sem uso.
+    void store(size_t pixel, const GBufferPixel& recorded);
+
+    // Recalcular o pixel com as luzes e acabamentos atuais da cena, sem
+    // lançar raios. Retorna a soma das amostras (como no buffer HDR).
+    Vec3 relightPixel(size_t pixel, const Scene& scene) const;
+};
+
+#endif
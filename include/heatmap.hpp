@@ -0,0 +1,28 @@
+// include/heatmap.hpp
+#ifndef HEATMAP_HPP
+#define HEATMAP_HPP
+
+#include "stats.hpp"
+#include "vec3.hpp"
+#include <string>
+#include <vector>
+
+// Medida de custo registrada por pixel
+enum HeatMetric { HEAT_TESTS, HEAT_RAYS, HEAT_TIME };
+
+bool parseHeatMetric(const std::string& name, HeatMetric& metric);
+const char* heatMetricName(HeatMetric metric);
+const char* heatMetricUnit(HeatMetric metric);
+
+// Valor do pixel a partir dos contadores (HEAT_TIME usa os microssegundos)
+double heatValue(HeatMetric metric, const RenderStats& stats, double micros);
+
+// Rampa de cores falsas (preto -> roxo -> vermelho -> amarelo -> branco), t em [0, 1]
+Vec3 heatColor(double t);
+
+// Salvar mapa de calor normalizado pelo percentil 99.5 (outliers saturam).
+// Retorna o valor de escala usado (topo da rampa) em 'scale'.
+bool writeHeatmap(const std::string& filename, int width, int height,
+                  const std::vector<float>& values, double& scale);
+
+#endif
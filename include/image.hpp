@@ -0,0 +1,29 @@
+// include/image.hpp
+#ifndef IMAGE_HPP
+#define IMAGE_HPP
+
+#include "vec3.hpp"
+#include "tonemap.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Imagem HDR acumulada: soma linear das amostras e número de amostras por pixel
+struct HDRImage {
+    int width = 0, height = 0;
+    std::vector<float> sums;       // RGB por pixel
+    std::vector<uint32_t> counts;
+
+    void resize(int w, int h);
+
+    // Cor linear média (preto sem amostras)
+    Vec3 average(int x, int y) const;
+};
+
+// Salvar em PPM texto (P3), com mapeamento de tons e gama
+bool writePPM(const std::string& filename, const HDRImage& image, ToneMap op, double gamma);
+
+// Codificar em PPM binário (P6) na memória
+std::vector<unsigned char> encodePPM(const HDRImage& image, ToneMap op, double gamma);
+
+#endif
@@ -0,0 +1,31 @@
+// include/incremental.hpp
+#ifndef INCREMENTAL_HPP
+#define INCREMENTAL_HPP
+
+#include "scene.hpp"
+#include <vector>
+
+// Diferença entre duas versões de uma cena
+struct SceneDiff {
+    bool full = false;                // Câmera, luzes ou número de elementos mudou
+    std::vector<int> changedObjects;  // Objetos com material ou geometria alterados
+    std::vector<AABB> newBounds;      // Caixas das novas posições dos objetos movidos
+};
+
+SceneDiff diffScenes(const Scene& before, const Scene& after);
+
+// A edição altera apenas cores/atenuação das luzes e coeficientes dos
+// acabamentos, sem mudar a visibilidade? (reiluminação pelo G-buffer)
+bool relightable(const Scene& before, const Scene& after);
+bool relightable(const std::vector<Light>& lightsBefore, const std::vector<Finish>& finishesBefore,
+                 const std::vector<Light>& lightsAfter, const std::vector<Finish>& finishesAfter);
+
+// Verificar se a caixa pode cruzar algum raio de um pixel. Os raios do pixel
+// são descritos por: caixas dos pontos atingidos em cada nível de recursão
+// (hitBounds[0..levels-1]), raios que escaparam (escapeBounds), raios primários
+// partindo do olho e raios de sombra até as luzes.
+bool raysMayCross(const AABB* hitBounds, int levels, const AABB& escapeBounds,
+                  const Vec3& eye, Real aperture,
+                  const std::vector<Light>& lights, const AABB& box);
+
+#endif
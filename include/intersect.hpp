@@ -3,9 +3,20 @@
 #define INTERSECT_HPP
 
 #include "scene.hpp"
+#include <vector>
 
-// Função principal
-HitInfo findClosestHit(const Ray& ray, const Scene& scene);
+struct RenderStats;
+
+// Função principal (stats opcional: testes por tipo de objeto e nós visitados)
+HitInfo findClosestHit(const Ray& ray, const Scene& scene, RenderStats* stats = nullptr);
+
+// Testar um único objeto (contado em stats como os demais testes)
+bool intersectObject(const Ray& ray, const Scene& scene, int idx, HitInfo& hit,
+                     RenderStats* stats = nullptr);
+
+// Testar apenas os objetos listados, sem BVH (candidatos de um tile para raios primários)
+HitInfo findClosestHit(const Ray& ray, const Scene& scene, const std::vector<int>& candidates,
+                       RenderStats* stats = nullptr);
 
 // Funções auxiliares de interseção
 namespace Intersect {
@@ -17,7 +28,7 @@ namespace Intersect {
     bool quadric(const Ray& ray, const Object& obj, HitInfo& hit);
     
     // Função genérica para resolver equação quadrática
-    bool solveQuadratic(double a, double b, double c, double& t1, double& t2);
+    bool solveQuadratic(Real a, Real b, Real c, Real& t1, Real& t2);
     
     // Ajustar normal para apontar contra o raio
     void adjustNormal(Vec3& normal, const Vec3& rayDir);
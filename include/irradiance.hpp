@@ -0,0 +1,74 @@
+// include/irradiance.hpp
+#ifndef IRRADIANCE_HPP
+#define IRRADIANCE_HPP
+
+#include "scene.hpp"
+#include <cstdint>
+#include <vector>
+
+// Parâmetros da iluminação global difusa (--gi)
+struct IrradianceParams {
+    int rays = 64;          // Raios por amostra do hemisfério
+    Real maxError = 0.3;    // Erro tolerado na reutilização ('a' de Ward)
+    int stride = 2;         // Passo da grade mais fina da pré-passada, em pixels
+};
+
+// Amostra do hemisfério: irradiância/π no ponto (multiplicada por kd e pela
+// cor da superfície dá a luz indireta difusa) e distância média harmônica das
+// superfícies vistas, que limita o alcance da reutilização
+struct IrradianceRecord {
+    Vec3 point;
+    Vec3 normal;
+    Vec3 value;
+    Real radius = 0;
+};
+
+// Ponto de sombreamento difuso atingido pelo raio central de um pixel ou pelo
+// seu caminho especular (reflexões/refrações)
+struct ShadingPoint {
+    Vec3 point;
+    Vec3 normal;
+    int depth = 0;
+};
+
+// Registros esparsos numa octree. Cada registro fica no nó cuja meia-aresta
+// cobre seu alcance (maxError × raio); a busca só desce nos nós cuja caixa,
+// aumentada do maior alcance da subárvore, contém o ponto.
+// Construída na pré-passada e apenas lida durante a renderização.
+class IrradianceCache {
+private:
+    struct Node {
+        Vec3 center;
+        Real half = 0;
+        Real reach = 0;     // Maior alcance entre os registros da subárvore
+        int children[8] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+        std::vector<IrradianceRecord> records;   // Guardados no nó: busca sem indireção
+    };
+
+    std::vector<Node> nodes;
+    size_t recordCount = 0;
+    Real minRadius = 0, maxRadius = 0;
+
+public:
+    IrradianceParams params;
+    uint64_t seed = 0;
+
+    // Esvaziar, com raiz cobrindo 'bounds' e limites do raio pela diagonal
+    void reset(const AABB& bounds, const IrradianceParams& p, uint64_t s);
+
+    // Inserir (raio limitado a [minRadius, maxRadius])
+    void insert(IrradianceRecord record);
+
+    // Média ponderada dos registros válidos em (point, normal), com o erro
+    // tolerado multiplicado por 'relax'; false se nenhum cobre o ponto
+    bool lookup(const Vec3& point, const Vec3& normal, Vec3& value, Real relax = 1) const;
+    bool covered(const Vec3& point, const Vec3& normal, Real relax = 1) const {
+        Vec3 unused;
+        return lookup(point, normal, unused, relax);
+    }
+
+    size_t size() const { return recordCount; }
+    bool empty() const { return recordCount == 0; }
+};
+
+#endif
@@ -3,9 +3,13 @@
 #define LOADER_HPP
 
 #include "scene.hpp"
+#include "stats.hpp"
 #include <string>
 
 bool loadPPM(const std::string& filename, Pigment& pigment);
-bool loadScene(const std::string& filename, Scene& scene);
+
+// Texturas são decodificadas no pool de threads em paralelo à leitura dos
+// acabamentos e objetos; 'timings' (opcional) recebe o tempo de cada etapa
+bool loadScene(const std::string& filename, Scene& scene, LoadTimings* timings = nullptr);
 
 #endif
\ No newline at end of file
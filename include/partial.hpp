@@ -0,0 +1,39 @@
+// include/partial.hpp
+#ifndef PARTIAL_HPP
+#define PARTIAL_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Retângulo de pixels [x0, x1) x [y0, y1)
+struct Region {
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+
+    int width() const { return x1 - x0; }
+    int height() const { return y1 - y0; }
+    bool empty() const { return x1 <= x0 || y1 <= y0; }
+    bool overlaps(const Region& o) const {
+        return x0 < o.x1 && o.x0 < x1 && y0 < o.y1 && o.y0 < y1;
+    }
+};
+
+// Faixa horizontal k de n ("--tile k/n") em uma imagem w x h
+Region tileRegion(int k, int n, int w, int h);
+
+// Imagem parcial: somas lineares e contagens de amostras de uma região,
+// prontas para serem somadas a outras parciais (mesma região ou não)
+struct PartialImage {
+    int width = 0, height = 0;   // Dimensões da imagem completa
+    Region region;
+    uint64_t seed = 0;
+    std::vector<float> sums;     // RGB por pixel da região
+    std::vector<uint32_t> counts;
+};
+
+// Formato: cabeçalho texto "RTPART 1" + dimensões, região e semente,
+// seguido dos dados binários (float RGB, depois uint32) na ordem do host
+bool savePartial(const std::string& filename, const PartialImage& part);
+bool loadPartial(const std::string& filename, PartialImage& part);
+
+#endif
@@ -3,9 +3,49 @@
 #define RAYTRACER_HPP
 
 #include "scene.hpp"
+#include "animation.hpp"
+#include "tracecontext.hpp"
+#include "tonemap.hpp"
+#include "denoise.hpp"
+#include "partial.hpp"
+#include "rng.hpp"
+#include "image.hpp"
+#include "camera.hpp"
+#include "stats.hpp"
+#include "heatmap.hpp"
+#include "irradiance.hpp"
+#include "encode.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+// Buffer do chamador que recebe cada tile assim que ele fica pronto
+struct FrameBuffer {
+    float* pixels = nullptr;  // RGB por pixel, coordenadas da imagem completa
+    int stride = 0;           // floats por linha (0: 3 * largura)
+    bool toneMapped = true;   // false: cor linear média (HDR)
+};
+
+// Parâmetros de uma chamada de render()
+struct RenderOptions {
+    Region region;            // Vazia: região de setRegion() (padrão: imagem inteira)
+    int tileSize = 32;
+    FrameBuffer* output = nullptr;
+    
+    // Chamado (serializado, em qualquer thread) a cada tile concluído
+    std::function<void(const Region& tile, int done, int total)> onTile;
+    
+    // Chamado (em qualquer thread, fora da trava) quando todos os tiles de uma
+    // linha de tiles terminam: as linhas [y0, y1) da imagem já são finais
+    std::function<void(int y0, int y1)> onRows;
+    
+    // Cancelamento cooperativo: verificado entre linhas de cada tile
+    const std::atomic<bool>* cancel = nullptr;
+};
+
 class RayTracer {
 private:
     int width, height;
@@ -13,29 +53,207 @@ private:
     double aperture;
     double focusDist;
     
-    Scene scene;
-    std::vector<unsigned char> frameBuffer;
+    // Amostras determinísticas por (semente, pixel) e região a renderizar
+    uint64_t seed;
+    Region region;
+    
+    // Cena renderizada, só leitura: própria ou compartilhada (p. ex. com a
+    // cache do servidor, sem cópia). ownedScene é a mesma cena quando ela
+    // pertence só a este RayTracer; nulo enquanto compartilhada.
+    std::shared_ptr<const Scene> scene;
+    std::shared_ptr<Scene> ownedScene;
+    
+    // Câmera que substitui a da cena (hasCamera), p. ex. por trabalho no servidor
+    bool hasCamera;
+    Camera camera;
+    
+    // Buffer HDR: soma linear das amostras e número de amostras por pixel.
+    // Mapeamento de tons e gama só são aplicados na saída.
+    HDRImage image;
+    ToneMap toneMapOp;
+    double gamma;
+    
+    // Modo incremental: dependências registradas por pixel
+    bool incremental;
+    int depWords;                          // Palavras de 64 bits por pixel
+    std::vector<uint64_t> pixelTouched;    // Objetos atingidos por qualquer raio do pixel
+    std::vector<AABB> pixelHitBounds;      // Pontos atingidos, por pixel e profundidade
+    std::vector<AABB> pixelEscapeBounds;   // Raios do pixel que escaparam da cena
+    std::vector<int> primaryIds;           // Objeto da primeira interseção primária
+    
+    // Modo de reiluminação: G-buffer com a árvore de raios de cada pixel
+    bool gbufferEnabled;
+    GBuffer gbuffer;
+    
+    // Denoiser: albedo, normal e profundidade do primeiro impacto
+    bool auxEnabled;
+    AuxBuffers aux;
+    
+    // Instrumentação: contadores somados por tile e tempo por fase
+    bool statsEnabled;
+    RenderStats stats;
+    PhaseTimings timings;
+    
+    // Aproximações rápidas no sombreamento (erro limitado, ver readme)
+    bool fastMath;
+    
+    // Iluminação global difusa: cache refeita pela pré-passada de cada render()
+    bool giEnabled;
+    IrradianceParams giParams;
+    IrradianceCache irradiance;
+    
+    // Mapa de calor: custo por pixel (testes, raios ou tempo)
+    bool heatmapEnabled;
+    HeatMetric heatMetric;
+    std::vector<float> heat;
     
     // Helpers
     struct CameraParams {
+        Vec3 eye;
+        double aperture;
+        double focusDist;
         Vec3 u, v, w;
         double aspectRatio;
         double viewportWidth;
         double viewportHeight;
     };
     
+    // Objetos candidatos dos raios primários de cada tile (mesma ordem dos
+    // tiles); tiles com candidatos demais ficam sem lista e usam a BVH
+    struct TileBins {
+        std::vector<std::vector<int>> lists;
+        std::vector<char> useBVH;
+    };
+    
     CameraParams setupCamera() const;
-    Ray generateRay(int x, int y, double jitterX, double jitterY, const CameraParams& cam) const;
+    CameraParams setupCamera(const Camera& view) const;
+    
+    // Cena para alteração: copia a compartilhada antes da primeira edição
+    Scene& editScene();
+    TileBins binTiles(const Region& area, int tileSize, const CameraParams& cam) const;
+    Ray generateRay(int x, int y, double jitterX, double jitterY, const CameraParams& cam,
+                    Rng& rng) const;
+    void renderPixel(int x, int y, const CameraParams& cam, RenderStats* tally = nullptr,
+                     const std::vector<int>* candidates = nullptr);
+    Vec3 samplePixel(int x, int y, const CameraParams& cam,   // Sem registros por pixel
+                     RenderStats* tally = nullptr) const;
+    static void storePixel(HDRImage& target, int pixel, const Vec3& sum, int count);
+    void resetDependencies();
+    void prepareRender(const CameraParams& cam);
+    size_t estimateGBufferNodes(const CameraParams& cam) const;
+    void buildIrradianceCache(const CameraParams& cam);
+    void copyTile(const Region& tile, FrameBuffer& output) const;
     
 public:
     RayTracer(int w = 800, int h = 600, int samples = 16);
     
     bool loadScene(const std::string& filename);
-    void render();
-    bool savePPM(const std::string& filename) const;
+    
+    // Renderizar em tiles no pool de threads. Retorna false se cancelado
+    // (tiles já concluídos permanecem no buffer). Não escreve em std::cout.
+    bool render(const RenderOptions& options);
+    void render() { render(RenderOptions()); }
+    
+    // Salvar no formato da extensão (.png, .qoi; as demais em PPM texto)
+    bool saveImage(const std::string& filename) const;
+    
+    // Codificador por faixas para 'filename' (nulo para PPM). Ligado em
+    // RenderOptions::onRows, comprime cada faixa enquanto os tiles seguintes
+    // ainda são renderizados; save() monta o arquivo ao final.
+    std::unique_ptr<ImageEncoder> createEncoder(const std::string& filename) const;
+    
+    // Usar uma cena já carregada (BVH incluída), p. ex. de um cache: é
+    // compartilhada sem cópia; edições posteriores copiam antes de alterar
+    void setScene(std::shared_ptr<const Scene> s);
+    const Scene& getScene() const { return *scene; }
+    
+    // Câmera própria no lugar da câmera da cena (abertura e foco incluídos)
+    void setCamera(const Camera& view) { camera = view; hasCamera = true; }
+    
+    // Imagem final em PPM binário (P6), pronta para envio
+    std::vector<unsigned char> encodePPM() const;
+    
+    // Várias câmeras sobre a mesma cena: tiles de todas as vistas dividem o
+    // pool, sem ociosidade entre vistas. onView é chamado, fora de qualquer
+    // trava, pela thread que termina a vista; vistas diferentes podem chamá-lo
+    // ao mesmo tempo. A imagem é liberada em seguida. Exige os modos
+    // incremental, G-buffer e denoiser desligados. Retorna false se cancelado.
+    bool renderBatch(const std::vector<Camera>& cameras,
+                     const std::function<void(int view, const HDRImage& image)>& onView,
+                     int tileSize = 32, const std::atomic<bool>* cancel = nullptr);
+    
+    // Sequência de quadros [first, last] reutilizando cena, texturas e BVH
+    bool renderSequence(const Animation& anim, int first, int last,
+                        const std::string& outputFile);
     
     void setSamples(int s) { samples = s; }
     void setDOF(double a, double f) { aperture = a; focusDist = f; }
+    void setToneMap(ToneMap op, double g = 1.0) { toneMapOp = op; gamma = g; }
+    void setSeed(uint64_t s) { seed = s; }
+    void setFastMath(bool on) { fastMath = on; }
+    
+    // Luz indireta difusa por cache de irradiância. Incompatível com
+    // reiluminação e lote de câmeras; --diff passa a retraçar tudo.
+    void setGlobalIllumination(bool on, const IrradianceParams& params = IrradianceParams()) {
+        giEnabled = on;
+        giParams = params;
+    }
+    
+    // Renderizar apenas parte da imagem (padrão: imagem inteira)
+    bool setRegion(const Region& r);
+    const Region& getRegion() const { return region; }
+    
+    // Somas e contagens da região, para juntar com outras parciais
+    PartialImage extractPartial() const;
+    bool savePartial(const std::string& filename) const;
+    
+    // Somar uma parcial ao buffer (mesma região com outra semente acumula amostras)
+    bool mergePartial(const PartialImage& part);
+    
+    // Cor linear média do pixel e cor final (tons mapeados) em [0, 1]
+    Vec3 getPixel(int x, int y) const;
+    Vec3 resolvePixel(int x, int y) const;
+    
+    const HDRImage& getImage() const { return image; }
+    const std::vector<float>& getAccumBuffer() const { return image.sums; }
+    const std::vector<uint32_t>& getSampleCounts() const { return image.counts; }
+    
+    // Registrar dependências por pixel para re-renderização incremental
+    void setIncremental(bool on) { incremental = on; }
+    const std::vector<int>& getPrimaryIds() const { return primaryIds; }
+    
+    // Trocar pela cena editada e retraçar apenas os pixels invalidados.
+    // Retorna o número de pixels retraçados (-1 em erro).
+    int rerenderEdited(const std::string& filename);
+    
+    // Gravar G-buffer (pontos, normais, pigmentos e sombras) durante render()
+    void setGBuffer(bool on) { gbufferEnabled = on; }
+    
+    // Reiluminar sem lançar raios: aceita apenas mudanças de cor/atenuação
+    // das luzes e de coeficientes dos acabamentos
+    bool relight(const std::vector<Light>& lights, const std::vector<Finish>& finishes);
+    bool relight(const std::string& filename);
+    
+    // Capturar buffers auxiliares durante render() para denoise()
+    void setDenoise(bool on) { auxEnabled = on; }
+    const AuxBuffers& getAuxBuffers() const { return aux; }
+    
+    // Filtro à-trous guiado pelos buffers auxiliares (pós-processamento)
+    bool denoise(const DenoiseParams& params = DenoiseParams());
+    
+    // Contar raios e interseções (acumulados até resetStats()); tempos por
+    // fase são sempre medidos pela última carga/renderização
+    void setStats(bool on) { statsEnabled = on; }
+    void resetStats() { stats = RenderStats(); }
+    const RenderStats& getStats() const { return stats; }
+    const PhaseTimings& getTimings() const { return timings; }
+    
+    // Registrar o custo de cada pixel durante render() (não afeta renderBatch)
+    void setHeatmap(bool on, HeatMetric metric = HEAT_TESTS) { heatmapEnabled = on; heatMetric = metric; }
+    const std::vector<float>& getHeatmap() const { return heat; }
+    
+    // Imagem em cores falsas; 'scale' recebe o valor do topo da rampa
+    bool saveHeatmap(const std::string& filename, double& scale) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+// include/rng.hpp
+#ifndef RNG_HPP
+#define RNG_HPP
+
+#include <cstdint>
+
+// Gerador pseudoaleatório pequeno (xorshift64*) semeado por pixel: a sequência
+// de amostras depende só da semente e do pixel, não da ordem de renderização.
+struct Rng {
+    uint64_t state;
+
+    // Mistura splitmix64 para espalhar sementes próximas
+    static uint64_t mix(uint64_t z) {
+        z += 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    Rng(uint64_t seed, uint64_t stream) : state(mix(seed ^ mix(stream)) | 1) {}
+
+    uint64_t nextU64() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+
+    // Uniforme em [0, 1)
+    double next() { return static_cast<double>(nextU64() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+#endif
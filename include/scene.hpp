@@ -6,8 +6,9 @@
 #include <vector>
 #include <string>
 
-// Constantes
-constexpr double EPSILON = 1e-6;
+// Constantes: tolerância das interseções (maior em float, onde 1e-6 fica
+// abaixo do arredondamento)
+constexpr Real EPSILON = sizeof(Real) < sizeof(double) ? Real(1e-5) : Real(1e-6);
 
 // Ray
 struct Ray {
@@ -15,7 +16,7 @@ struct Ray {
     Vec3 direction;
     
     Ray(const Vec3& o, const Vec3& d) : origin(o), direction(d.normalize()) {}
-    Vec3 at(double t) const { return origin + direction * t; }
+    Vec3 at(Real t) const { return origin + direction * t; }
 };
 
 // Pigment
@@ -25,35 +26,81 @@ struct Pigment {
     PigmentType type = SOLID;
     Vec3 color1 = Vec3(1, 1, 1);
     Vec3 color2 = Vec3(0, 0, 0);
-    double scale = 1.0;
+    Real scale = 1.0;
     
     // Textura
     std::string texturePath;
-    double p0[4] = {0, 0, 0, 0};
-    double p1[4] = {0, 0, 0, 0};
+    Real p0[4] = {0, 0, 0, 0};
+    Real p1[4] = {0, 0, 0, 0};
     std::vector<Vec3> textureData;
     int textureWidth = 0, textureHeight = 0;
 };
 
 // Finish
 struct Finish {
-    double ka = 0.1;    // Ambiente
-    double kd = 0.7;    // Difuso
-    double ks = 0.2;    // Especular
-    double alpha = 50.0; // Expoente especular
-    double kr = 0.0;    // Reflexão
-    double kt = 0.0;    // Transmissão
-    double ior = 1.5;   // Índice refração
+    Real ka = 0.1;    // Ambiente
+    Real kd = 0.7;    // Difuso
+    Real ks = 0.2;    // Especular
+    Real alpha = 50.0; // Expoente especular
+    Real kr = 0.0;    // Reflexão
+    Real kt = 0.0;    // Transmissão
+    Real ior = 1.5;   // Índice refração
 };
 
 // Plano
 struct Plane {
-    double a, b, c, d;
+    Real a, b, c, d;
     
-    Plane(double a = 0, double b = 0, double c = 1, double d = 0);
+    Plane(Real a = 0, Real b = 0, Real c = 1, Real d = 0);
     void normalize();
     Vec3 normal() const { return Vec3(a, b, c); }
-    double distance(const Vec3& p) const { return a*p.x + b*p.y + c*p.z + d; }
+    Real distance(const Vec3& p) const { return a*p.x + b*p.y + c*p.z + d; }
+};
+
+// Largura do bloco do teste vetorizado de poliedros (registradores de 256 bits)
+constexpr size_t PLANE_LANES = 32 / sizeof(Real);
+
+// Planos em estrutura de arrays, completados até múltiplo de PLANE_LANES com
+// planos neutros (0x + 0y + 0z - 1 <= 0, sempre satisfeito): o laço do teste
+// percorre blocos inteiros, sem resto
+struct PlaneSoA {
+    std::vector<Real> a, b, c, d;
+    
+    void assign(const std::vector<Plane>& planes);
+    size_t size() const { return a.size(); }
+};
+
+// Caixa delimitadora alinhada aos eixos
+struct AABB {
+    Vec3 min = Vec3(1e30, 1e30, 1e30);
+    Vec3 max = Vec3(-1e30, -1e30, -1e30);
+    
+    bool valid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    Vec3 center() const { return (min + max) * 0.5; }
+    Vec3 extent() const { return max - min; }
+    Real surfaceArea() const {
+        if (!valid()) return 0;
+        Vec3 e = extent();
+        return 2 * (e.x*e.y + e.y*e.z + e.z*e.x);
+    }
+    void expand(const Vec3& p) {
+        min = Vec3(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+        max = Vec3(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+    }
+    bool contains(const Vec3& p) const {
+        return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y &&
+               p.z >= min.z && p.z <= max.z;
+    }
+    bool overlaps(const AABB& b) const {
+        return min.x <= b.max.x && max.x >= b.min.x &&
+               min.y <= b.max.y && max.y >= b.min.y &&
+               min.z <= b.max.z && max.z >= b.min.z;
+    }
+    void expand(const AABB& b) {
+        if (!b.valid()) return;
+        expand(b.min);
+        expand(b.max);
+    }
 };
 
 // Tipos de objetos
@@ -62,20 +109,64 @@ enum ObjectType { SPHERE, POLYHEDRON, QUADRIC, TRIANGLE, CYLINDER, CONE };
 // Dados específicos de objetos
 struct SphereData {
     Vec3 center = Vec3(0, 0, 0);
-    double radius = 1.0;
+    Real radius = 1.0;
+};
+
+// Classes de quádrica reconhecidas na carga (classifyQuadric)
+enum QuadricClass {
+    QUADRIC_GENERAL,      // Termos cruzados (eixos girados): núcleo completo
+    QUADRIC_SPHERE,
+    QUADRIC_ELLIPSOID,
+    QUADRIC_CYLINDER,     // Cilindro elíptico ou circular, infinito
+    QUADRIC_CONE,         // Cone duplo elíptico ou circular
+    QUADRIC_PARABOLOID,   // Elíptico ou hiperbólico
+    QUADRIC_HYPERBOLOID,  // De uma ou duas folhas
+    QUADRIC_PLANE,        // Sem termos quadráticos
+    QUADRIC_OTHER,        // Demais alinhadas aos eixos (pares de planos, vazias...)
+    QUADRIC_CLASS_COUNT
+};
+
+// Núcleo de interseção escolhido pela classe
+enum QuadricKernel {
+    QKERNEL_GENERAL,    // Dez coeficientes
+    QKERNEL_AXIS,       // Forma centrada sem termos cruzados
+    QKERNEL_ELLIPSOID,  // Esfera unitária após escala por eixo
+    QKERNEL_PLANE       // Equação linear
 };
 
 struct QuadricData {
-    double A = 0, B = 0, C = 0, D = 0, E = 0, F = 0;
-    double G = 0, H = 0, I = 0, J = 0;
+    Real A = 0, B = 0, C = 0, D = 0, E = 0, F = 0;
+    Real G = 0, H = 0, I = 0, J = 0;
+    
+    // Forma centrada (núcleos especializados), com u = p - center:
+    //   eixos/plano: diag·(u∘u) + linear·u + constant = 0
+    //   elipsoide:   |diag∘u| = 1 (diag = inverso dos semieixos)
+    QuadricClass shape = QUADRIC_GENERAL;
+    QuadricKernel kernel = QKERNEL_GENERAL;
+    Vec3 center, diag, linear;
+    Real constant = 0;
+    
+    // Volumes de corte opcionais: só a parte da superfície dentro da caixa e
+    // de todos os semi-espaços (a·x + b·y + c·z + d <= 0) existe
+    AABB clipBox;                 // Inválida: sem caixa
+    std::vector<Plane> clipPlanes;
+    
+    bool clipped() const { return clipBox.valid() || !clipPlanes.empty(); }
+    bool insideClip(const Vec3& p) const {
+        if (clipBox.valid() && !clipBox.contains(p)) return false;
+        for (const auto& plane : clipPlanes) {
+            if (plane.distance(p) > 0) return false;
+        }
+        return true;
+    }
 };
 
 struct CylinderConeData {
     Vec3 base = Vec3(0, 0, 0);
     Vec3 axis = Vec3(0, 1, 0);
-    double height = 1.0;
-    double radius1 = 1.0;
-    double radius2 = 1.0;
+    Real height = 1.0;
+    Real radius1 = 1.0;
+    Real radius2 = 1.0;
 };
 
 struct TriangleData {
@@ -93,11 +184,13 @@ struct Object {
     // Union de dados
     SphereData sphere;
     std::vector<Plane> faces;
+    PlaneSoA faceSoA;   // Cópia de faces usada na interseção (refazer ao alterar faces)
     QuadricData quadric;
     CylinderConeData cylinderCone;
     TriangleData triangle;
 };
 
+
 // Light
 struct Light {
     Vec3 position;
@@ -112,19 +205,47 @@ struct Light {
 // HitInfo
 struct HitInfo {
     bool hit = false;
-    double t = 1e10;
+    Real t = 1e10;
     Vec3 point;
     Vec3 normal;
     int objectIdx = -1;
 };
 
+// Nó da BVH (folha quando count > 0)
+struct BVHNode {
+    AABB bounds;
+    int left = -1, right = -1;
+    int first = 0, count = 0;
+};
+
+// Hierarquia de volumes envolventes
+struct BVH {
+    std::vector<BVHNode> nodes;
+    std::vector<int> objectIndices;  // Objetos referenciados pelas folhas
+    std::vector<int> unbounded;      // Objetos sem extensão finita (quádricas, semi-espaços)
+    std::vector<AABB> objectBounds;  // Caixa de cada objeto da cena (inválida: ilimitado)
+    Real buildArea = 0.0;          // Área da raiz no momento da construção
+    
+    bool empty() const { return nodes.empty(); }
+};
+
+// Recursos de material presentes na cena. O sombreamento tem uma variante
+// especializada para cada combinação; a cena escolhe a menor que a cobre.
+enum ShadeFeature : unsigned {
+    SHADE_REFLECTION = 1,   // Algum acabamento com kr > 0
+    SHADE_REFRACTION = 2,   // Algum acabamento com kt > 0
+    SHADE_PATTERN = 4,      // Algum pigmento xadrez ou textura
+    SHADE_ALL = 7,
+    SHADE_FAST = 8          // Não é recurso da cena: modo --fast-math do contexto
+};
+
 // Scene
 struct Scene {
     // Câmera
     Vec3 eye;
     Vec3 lookAt;
     Vec3 up;
-    double fovy;
+    Real fovy;
     
     // Elementos
     std::vector<Light> lights;
@@ -132,7 +253,32 @@ struct Scene {
     std::vector<Finish> finishes;
     std::vector<Object> objects;
     
+    // Estrutura de aceleração
+    BVH bvh;
+    
+    // Variante de sombreamento (SHADE_ALL: genérica, sempre correta)
+    unsigned features = SHADE_ALL;
+    
+    // Quádricas da entrada por classe; 'rewritten' conta as que viraram
+    // esfera, cilindro ou cone nativos
+    int quadricClasses[QUADRIC_CLASS_COUNT] = {};
+    int quadricRewritten[QUADRIC_CLASS_COUNT] = {};
+    
     Scene() : eye(0,0,0), lookAt(0,0,-1), up(0,1,0), fovy(40) {}
 };
 
+// Transladar a geometria de um objeto
+void translateObject(Object& obj, const Vec3& offset);
+
+// Classificar a quádrica do objeto e preparar seu núcleo. Esferas, cilindros
+// e cones circulares cujo corte o tipo nativo reproduz exatamente viram esse
+// tipo (retorna true). Objetos que não são quádricas ficam intactos.
+bool classifyQuadric(Object& obj);
+
+// Classificar todas as quádricas da cena, preenchendo as contagens
+void classifyQuadrics(Scene& scene);
+
+// Recursos de material usados pelos objetos da cena (máscara de ShadeFeature)
+unsigned shadeFeatures(const Scene& scene);
+
 #endif
\ No newline at end of file
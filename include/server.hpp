@@ -0,0 +1,26 @@
+// include/server.hpp
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <string>
+
+// Modo servidor: processo persistente que mantém cenas carregadas (com BVH)
+// em cache e executa trabalhos em paralelo no pool de threads global.
+//
+// Protocolo por linhas de texto; cada requisição é uma linha:
+//   render <id> <cena.in> <largura> <altura> <amostras> [chave=valor...]
+//       chaves: eye=x,y,z lookat=x,y,z up=x,y,z fovy=g aperture=a focus=f
+//               seed=s tonemap=clamp|reinhard|aces gamma=g
+//   evict <cena.in>   descartar a cena do cache
+//   quit              encerrar a sessão após os trabalhos pendentes
+// Respostas (podem chegar fora de ordem; use o id):
+//   ok <id> <ms> <bytes>\n seguido de <bytes> de imagem PPM binária (P6)
+//   error <id> <mensagem>\n
+
+// Sessão única sobre stdin/stdout (mensagens de log vão para stderr)
+int runStdioServer();
+
+// Aceitar conexões em um socket Unix local; uma sessão por conexão
+int runSocketServer(const std::string& path);
+
+#endif
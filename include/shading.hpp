@@ -3,10 +3,46 @@
 #define SHADING_HPP
 
 #include "scene.hpp"
+#include "tracecontext.hpp"
+#include "irradiance.hpp"
+#include <limits>
+#include <string>
+#include <vector>
 
 constexpr int MAX_DEPTH = 5;
-constexpr double SHADOW_BIAS = 0.001;
+constexpr Real SHADOW_BIAS = 0.001;
+constexpr Real RAY_FAR = 1e20; // Extremo usado para raios que não atingem nada
 
-Vec3 traceRay(const Ray& ray, const Scene& scene, int depth = 0);
+// Origem de um raio secundário, afastada da superfície ao longo de 'normal'.
+// Em float o arredondamento cresce com a magnitude das coordenadas, então o
+// afastamento acompanha a maior delas (em double fica em SHADOW_BIAS).
+inline Vec3 offsetOrigin(const Vec3& point, const Vec3& normal) {
+    constexpr Real RELATIVE_BIAS = 64 * std::numeric_limits<Real>::epsilon();
+    Real scale = std::max({std::fabs(point.x), std::fabs(point.y), std::fabs(point.z)});
+    return point + normal * std::max(SHADOW_BIAS, scale * RELATIVE_BIAS);
+}
+
+// Traçar um raio usando a variante de sombreamento de scene.features
+Vec3 traceRay(const Ray& ray, const Scene& scene, int depth = 0, TraceContext* ctx = nullptr);
+
+// Iluminação global difusa: amostra do hemisfério em 'at' (cache.params.rays
+// raios, sequência fixada pela semente da cache e pelo ponto)
+IrradianceRecord sampleIrradiance(const ShadingPoint& at, const Scene& scene,
+                                  const IrradianceCache& cache, TraceContext* ctx = nullptr);
+
+// Pontos difusos atingidos pelo raio e pelo seu caminho especular (pré-passada)
+void gatherShadingPoints(const Ray& ray, const Scene& scene, std::vector<ShadingPoint>& out);
+
+// Nome da variante (ex.: "reflexão+padrões"; "básica" sem nenhum recurso;
+// sufixo " (rápida)" com SHADE_FAST)
+std::string shadeVariantName(unsigned features);
+
+// Cor dos raios que não atingem nenhum objeto
+inline Vec3 backgroundColor() { return Vec3(0.1, 0.1, 0.1); }
+
+// Termos de Phong (reutilizados pela reiluminação a partir do G-buffer)
+Vec3 ambientTerm(const Vec3& baseColor, const Scene& scene, const Finish& finish);
+Vec3 directTerm(const Vec3& baseColor, const Vec3& point, const Vec3& normal,
+                const Vec3& viewDir, const Light& light, const Finish& finish);
 
 #endif
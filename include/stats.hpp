@@ -0,0 +1,71 @@
+// include/stats.hpp
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include "scene.hpp"
+#include <cstdint>
+#include <ostream>
+
+constexpr int OBJECT_TYPE_COUNT = CONE + 1;
+
+// Contadores de uma renderização. Cada tarefa conta em uma cópia local
+// (sem atômicos) e as cópias são somadas com merge() ao final.
+struct RenderStats {
+    uint64_t primaryRays = 0;
+    uint64_t shadowRays = 0;
+    uint64_t reflectionRays = 0;
+    uint64_t refractionRays = 0;
+    uint64_t binnedRays = 0;                 // Primários testados só contra a lista do tile
+    uint64_t shadowCacheHits = 0;            // Sombras resolvidas pelo último oclusor da luz
+    uint64_t shadowCacheMisses = 0;          // Sombras que consultaram a cena inteira
+    uint64_t irradianceRays = 0;             // Raios do hemisfério (--gi)
+    uint64_t irradianceRecords = 0;          // Registros criados na pré-passada
+    uint64_t irradianceReused = 0;           // Pontos servidos pela cache
+    uint64_t irradianceComputed = 0;         // Pontos sem registro: amostrados na hora
+    uint64_t depthSum = 0;                   // Soma das profundidades dos raios traçados
+    uint64_t bvhNodes = 0;                   // Nós da BVH visitados
+    uint64_t tests[OBJECT_TYPE_COUNT] = {};  // Testes de interseção por tipo de objeto
+    uint64_t hits[OBJECT_TYPE_COUNT] = {};   // Testes com interseção
+
+    void merge(const RenderStats& other);
+
+    uint64_t tracedRays() const { return primaryRays + reflectionRays + refractionRays; }
+    uint64_t totalRays() const { return tracedRays() + shadowRays + irradianceRays; }
+    double averageDepth() const {
+        return tracedRays() ? static_cast<double>(depthSum) / tracedRays() : 0.0;
+    }
+};
+
+// Etapas da carga da cena, em milissegundos. As texturas são decodificadas
+// no pool enquanto o resto do arquivo é lido.
+struct LoadTimings {
+    double parseMs = 0.0;        // Leitura do arquivo de cena
+    double textureMs = 0.0;      // Decodificação das texturas (soma das tarefas)
+    double textureWaitMs = 0.0;  // Espera pelas texturas após a leitura
+    double prepareMs = 0.0;      // Classificação das quádricas e recursos da cena
+    int textures = 0;
+};
+
+// Tempo de parede por fase, em milissegundos
+struct PhaseTimings {
+    double loadMs = 0.0;    // Leitura da cena e texturas
+    LoadTimings load;       // Etapas de loadMs
+    double bvhMs = 0.0;     // Construção da BVH
+    double cameraMs = 0.0;  // Preparação da câmera e buffers
+    double giMs = 0.0;      // Pré-passada da cache de irradiância (--gi)
+    double renderMs = 0.0;
+    double saveMs = 0.0;
+
+    double totalMs() const { return loadMs + bvhMs + cameraMs + giMs + renderMs + saveMs; }
+};
+
+const char* objectTypeName(ObjectType type);
+const char* quadricClassName(QuadricClass shape);
+
+// Relatórios (texto legível ou JSON em uma linha); da cena vêm as classes das quádricas
+void printStats(std::ostream& out, const RenderStats& stats, const PhaseTimings& timings,
+                const Scene& scene);
+void writeStatsJSON(std::ostream& out, const RenderStats& stats, const PhaseTimings& timings,
+                    const Scene& scene, int width, int height, int samples, int threads);
+
+#endif
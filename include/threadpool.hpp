@@ -0,0 +1,76 @@
+// include/threadpool.hpp
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de threads fixo. parallelFor() também executa na thread chamadora,
+// então pode ser chamado de dentro de uma tarefa do próprio pool.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping;
+
+    void workerLoop();
+
+public:
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return static_cast<int>(workers.size()); }
+
+    void submit(std::function<void()> task);
+
+    // Executar body(i) para i em [0, count) e aguardar o término
+    void parallelFor(int count, const std::function<void(int)>& body);
+
+    // Pool compartilhado do processo (uma thread por núcleo)
+    static ThreadPool& global();
+};
+
+// Tarefas independentes lançadas aos poucos no pool. wait() executa na thread
+// chamadora as que nenhuma thread pegou ainda e aguarda as demais, então
+// também pode ser usado de dentro de uma tarefa do pool.
+class TaskGroup {
+private:
+    struct Task {
+        std::function<void()> body;
+        std::atomic<bool> claimed{false};
+    };
+    struct State {
+        std::mutex mutex;
+        std::condition_variable finished;
+        int done = 0;
+    };
+
+    ThreadPool& pool;
+    std::shared_ptr<State> state;
+    std::vector<std::shared_ptr<Task>> tasks;
+
+    static void execute(Task& task, State& state);
+
+public:
+    explicit TaskGroup(ThreadPool& p = ThreadPool::global());
+    ~TaskGroup() { wait(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> task);
+    void wait();
+};
+
+#endif
@@ -0,0 +1,21 @@
+// include/tonemap.hpp
+#ifndef TONEMAP_HPP
+#define TONEMAP_HPP
+
+#include "vec3.hpp"
+#include <string>
+
+// Operadores de mapeamento de tons (HDR -> [0, 1])
+enum ToneMap { TONEMAP_CLAMP, TONEMAP_REINHARD, TONEMAP_ACES };
+
+bool parseToneMap(const std::string& name, ToneMap& op);
+
+// Mapear cor linear para [0, 1] e aplicar gama
+Vec3 toneMap(const Vec3& color, ToneMap op, double gamma = 1.0);
+
+// Converter canal em [0, 1] para 8 bits
+inline unsigned char toByte(double v) {
+    return static_cast<unsigned char>(std::clamp(v * 255.0, 0.0, 255.0));
+}
+
+#endif
@@ -0,0 +1,64 @@
+// include/trace.hpp
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Linha do tempo por thread (--trace) no formato de eventos do Chrome, para
+// chrome://tracing ou Perfetto. Cada thread grava intervalos num buffer só
+// seu, sem trava nem atômicos; o buffer é registrado uma vez por thread.
+// Desligada, cada intervalo custa uma leitura atômica relaxada.
+
+namespace trace_detail {
+extern std::atomic<bool> enabled;
+int64_t now();   // Nanossegundos desde traceEnable()
+void record(const char* category, const char* name, int64_t start, int64_t end,
+            const char* arg0, int value0, const char* arg1, int value1);
+}
+
+// Começar a gravar (descarta eventos anteriores)
+void traceEnable();
+
+inline bool traceEnabled() {
+    return trace_detail::enabled.load(std::memory_order_relaxed);
+}
+
+// Gravar os eventos de todas as threads em JSON. Só pode ser chamado com o
+// pool ocioso: os buffers são lidos sem sincronização própria.
+bool writeTrace(const std::string& filename);
+
+// Intervalo do construtor ao destrutor na thread atual. Nomes e categorias
+// são literais (só o ponteiro é guardado); até dois argumentos inteiros.
+class TraceScope {
+private:
+    const char* category;
+    const char* name;
+    const char* arg0;
+    const char* arg1;
+    int value0, value1;
+    int64_t start;
+
+public:
+    TraceScope(const char* cat, const char* n, const char* a0 = nullptr, int v0 = 0,
+               const char* a1 = nullptr, int v1 = 0)
+        : category(cat), name(n), arg0(a0), arg1(a1), value0(v0), value1(v1),
+          start(traceEnabled() ? trace_detail::now() : -1) {}
+
+    ~TraceScope() { end(); }
+
+    // Fechar antes do fim do bloco (só a primeira chamada grava)
+    void end() {
+        if (start >= 0) {
+            trace_detail::record(category, name, start, trace_detail::now(),
+                                 arg0, value0, arg1, value1);
+            start = -1;
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#endif
@@ -0,0 +1,57 @@
+// include/tracecontext.hpp
+#ifndef TRACECONTEXT_HPP
+#define TRACECONTEXT_HPP
+
+#include "scene.hpp"
+#include "gbuffer.hpp"
+#include "stats.hpp"
+#include <cstdint>
+#include <vector>
+
+class IrradianceCache;
+
+// Estado opcional carregado ao longo da recursão de um pixel
+struct TraceContext {
+    // Modo incremental: objetos atingidos (bitset), caixas dos pontos atingidos
+    // por profundidade de recursão e caixa dos raios que escaparam da cena
+    uint64_t* touched = nullptr;
+    AABB* hitBounds = nullptr;    // Uma caixa por nível de profundidade
+    AABB* escapeBounds = nullptr;
+    int primaryObject = -1; // Objeto atingido pelo último raio primário
+    
+    // Modo de reiluminação: árvore de pontos de sombreamento do pixel
+    GBufferPixel* gbuffer = nullptr;
+    
+    // Buffers auxiliares do denoiser: somas sobre os raios primários
+    bool captureAux = false;
+    Vec3 auxAlbedo;
+    Vec3 auxNormal;
+    double auxDepth = 0.0;
+    
+    // Contadores de raios e interseções (cópia local da tarefa)
+    RenderStats* stats = nullptr;
+    
+    // Aproximações rápidas no sombreamento (--fast-math)
+    bool fastMath = false;
+    
+    // Raios primários: objetos que podem aparecer no tile (nulo: percorrer a BVH)
+    const std::vector<int>* primaryCandidates = nullptr;
+    
+    // Iluminação global difusa (--gi): cache pronta, só leitura (nulo: desligada)
+    const IrradianceCache* irradiance = nullptr;
+
+    bool recording() const { return touched != nullptr; }
+
+    void recordHit(int objectIdx) {
+        if (objectIdx >= 0) touched[objectIdx >> 6] |= uint64_t(1) << (objectIdx & 63);
+    }
+
+    void recordHitPoint(int depth, const Vec3& point) { hitBounds[depth].expand(point); }
+
+    void recordEscape(const Vec3& from, const Vec3& to) {
+        escapeBounds->expand(from);
+        escapeBounds->expand(to);
+    }
+};
+
+#endif
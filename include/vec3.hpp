@@ -6,43 +6,51 @@
 #include <iostream>
 #include <algorithm>
 
+// Escalar da geometria e do sombreamento: double por padrão, float quando
+// compilado com -DRT_FLOAT (alvo 'make float')
+#ifdef RT_FLOAT
+typedef float Real;
+#else
+typedef double Real;
+#endif
+
 class Vec3 {
 public:
-    double x, y, z;
+    Real x, y, z;
     
     Vec3() : x(0), y(0), z(0) {}
-    Vec3(double x, double y, double z) : x(x), y(y), z(z) {}
+    Vec3(Real x, Real y, Real z) : x(x), y(y), z(z) {}
     
     // Operadores aritméticos
     Vec3 operator+(const Vec3& v) const { return Vec3(x+v.x, y+v.y, z+v.z); }
     Vec3 operator-(const Vec3& v) const { return Vec3(x-v.x, y-v.y, z-v.z); }
-    Vec3 operator*(double s) const { return Vec3(x*s, y*s, z*s); }
-    Vec3 operator/(double s) const { return *this * (1.0/s); }
+    Vec3 operator*(Real s) const { return Vec3(x*s, y*s, z*s); }
+    Vec3 operator/(Real s) const { return *this * (Real(1)/s); }
     Vec3 operator-() const { return Vec3(-x, -y, -z); }
     
     // Multiplicação componente a componente
     Vec3 mul(const Vec3& v) const { return Vec3(x*v.x, y*v.y, z*v.z); }
     
     // Produtos
-    double dot(const Vec3& v) const { return x*v.x + y*v.y + z*v.z; }
+    Real dot(const Vec3& v) const { return x*v.x + y*v.y + z*v.z; }
     Vec3 cross(const Vec3& v) const { 
         return Vec3(y*v.z - z*v.y, z*v.x - x*v.z, x*v.y - y*v.x); 
     }
     
     // Métodos
-    double length() const { return std::sqrt(x*x + y*y + z*z); }
-    double lengthSquared() const { return x*x + y*y + z*z; }
+    Real length() const { return std::sqrt(x*x + y*y + z*z); }
+    Real lengthSquared() const { return x*x + y*y + z*z; }
     
     Vec3 normalize() const { 
-        double len = length();
+        Real len = length();
         return len > 0 ? *this / len : *this;
     }
     
     Vec3 reflect(const Vec3& normal) const {
-        return *this - normal * (2.0 * this->dot(normal));
+        return *this - normal * (2 * this->dot(normal));
     }
     
-    Vec3 clamp(double min = 0.0, double max = 1.0) const {
+    Vec3 clamp(Real min = 0, Real max = 1) const {
         return Vec3(
             std::clamp(x, min, max),
             std::clamp(y, min, max),
@@ -57,6 +65,6 @@ public:
 };
 
 // Operador externo para s * v
-inline Vec3 operator*(double s, const Vec3& v) { return v * s; }
+inline Vec3 operator*(Real s, const Vec3& v) { return v * s; }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,161 @@
+// src/animation.cpp
+#include "../include/animation.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+Vec3 lerp(const Vec3& a, const Vec3& b, double s) { return a + (b - a) * s; }
+double lerp(double a, double b, double s) { return a + (b - a) * s; }
+
+// Localizar o par de chaves que envolve o quadro e o peso de interpolação
+template<typename Key>
+void bracket(const std::vector<Key>& keys, int frame, const Key*& k0, const Key*& k1, double& s) {
+    auto it = std::upper_bound(keys.begin(), keys.end(), frame,
+                               [](int f, const Key& k) { return f < k.frame; });
+    if (it == keys.begin()) { k0 = k1 = &keys.front(); s = 0; return; }
+    if (it == keys.end())   { k0 = k1 = &keys.back();  s = 0; return; }
+    k0 = &*(it - 1);
+    k1 = &*it;
+    s = static_cast<double>(frame - k0->frame) / (k1->frame - k0->frame);
+}
+
+template<typename Key>
+void sortKeys(std::vector<Key>& keys) {
+    std::stable_sort(keys.begin(), keys.end(),
+                     [](const Key& a, const Key& b) { return a.frame < b.frame; });
+}
+
+bool readVec3(std::ifstream& file, Vec3& v) {
+    return static_cast<bool>(file >> v.x >> v.y >> v.z);
+}
+
+} // namespace anônimo
+
+bool loadAnimation(const std::string& filename, Animation& anim) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Erro ao abrir animação: " << filename << std::endl;
+        return false;
+    }
+
+    bool hasRange = false;
+    int maxFrame = 0;
+    std::string keyword;
+
+    while (file >> keyword) {
+        if (keyword[0] == '#') {
+            std::getline(file, keyword);
+            continue;
+        }
+
+        if (keyword == "frames") {
+            if (!(file >> anim.firstFrame >> anim.lastFrame)) return false;
+            hasRange = true;
+        }
+        else if (keyword == "camera") {
+            CameraKey key;
+            if (!(file >> key.frame && readVec3(file, key.eye) && readVec3(file, key.lookAt) &&
+                  readVec3(file, key.up) && file >> key.fovy)) return false;
+            anim.camera.push_back(key);
+            maxFrame = std::max(maxFrame, key.frame);
+        }
+        else if (keyword == "light") {
+            LightKey key;
+            int idx;
+            if (!(file >> key.frame >> idx && readVec3(file, key.position) &&
+                  readVec3(file, key.color))) return false;
+            anim.lights[idx].push_back(key);
+            maxFrame = std::max(maxFrame, key.frame);
+        }
+        else if (keyword == "object") {
+            ObjectKey key;
+            int idx;
+            if (!(file >> key.frame >> idx && readVec3(file, key.offset))) return false;
+            anim.objects[idx].push_back(key);
+            maxFrame = std::max(maxFrame, key.frame);
+        }
+        else {
+            std::cerr << "Palavra-chave de animação desconhecida: " << keyword << std::endl;
+            return false;
+        }
+    }
+
+    sortKeys(anim.camera);
+    for (auto& track : anim.lights) sortKeys(track.second);
+    for (auto& track : anim.objects) sortKeys(track.second);
+
+    if (!hasRange) {
+        anim.firstFrame = 0;
+        anim.lastFrame = maxFrame;
+    }
+
+    return true;
+}
+
+bool checkAnimation(const Animation& anim, const Scene& scene) {
+    for (const auto& track : anim.lights) {
+        if (track.first < 0 || track.first >= static_cast<int>(scene.lights.size())) {
+            std::cerr << "Luz inexistente na animação: " << track.first << std::endl;
+            return false;
+        }
+    }
+    for (const auto& track : anim.objects) {
+        if (track.first < 0 || track.first >= static_cast<int>(scene.objects.size())) {
+            std::cerr << "Objeto inexistente na animação: " << track.first << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool applyAnimationFrame(const Animation& anim, int frame,
+                         const std::vector<Object>& base, Scene& scene) {
+    double s;
+
+    // Câmera
+    if (!anim.camera.empty()) {
+        const CameraKey *k0, *k1;
+        bracket(anim.camera, frame, k0, k1, s);
+        scene.eye = lerp(k0->eye, k1->eye, s);
+        scene.lookAt = lerp(k0->lookAt, k1->lookAt, s);
+        scene.up = lerp(k0->up, k1->up, s);
+        scene.fovy = lerp(k0->fovy, k1->fovy, s);
+    }
+
+    // Luzes
+    for (const auto& track : anim.lights) {
+        const LightKey *k0, *k1;
+        bracket(track.second, frame, k0, k1, s);
+        Light& light = scene.lights[track.first];
+        light.position = lerp(k0->position, k1->position, s);
+        light.color = lerp(k0->color, k1->color, s);
+    }
+
+    // Objetos: sempre a partir da geometria base para não acumular erro
+    bool moved = false;
+    for (const auto& track : anim.objects) {
+        const ObjectKey *k0, *k1;
+        bracket(track.second, frame, k0, k1, s);
+        Object& obj = scene.objects[track.first];
+        obj = base[track.first];
+        translateObject(obj, lerp(k0->offset, k1->offset, s));
+        moved = true;
+    }
+
+    return moved;
+}
+
+std::string frameFileName(const std::string& filename, int frame) {
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_%04d", frame);
+
+    size_t dot = filename.find_last_of('.');
+    size_t slash = filename.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return filename + suffix;
+    }
+    return filename.substr(0, dot) + suffix + filename.substr(dot);
+}
@@ -0,0 +1,427 @@
+// src/bvh.cpp
+#include "../include/bvh.hpp"
+#include "../include/threadpool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr int MAX_LEAF_SIZE = 2;
+
+// Sub-árvores menores que isso são construídas na própria thread
+constexpr int PARALLEL_BUILD_MIN = 4096;
+
+// Objetos por tarefa no cálculo das caixas
+constexpr int BOUNDS_CHUNK = 256;
+
+// Caixa de um disco de raio r centrado em c com normal n (unitária)
+AABB diskBounds(const Vec3& c, const Vec3& n, Real r) {
+    Vec3 e(r * std::sqrt(std::max(Real(0), 1 - n.x*n.x)),
+           r * std::sqrt(std::max(Real(0), 1 - n.y*n.y)),
+           r * std::sqrt(std::max(Real(0), 1 - n.z*n.z)));
+    AABB box;
+    box.expand(c - e);
+    box.expand(c + e);
+    return box;
+}
+
+// Ponto em double mesmo no build float: os vértices saem de um cubo enorme
+// cortado plano a plano, e as coordenadas dele perderiam as do poliedro
+struct Point3d {
+    double x, y, z;
+};
+
+using Polygon3d = std::vector<Point3d>;
+
+// Meia-aresta do cubo inicial. Vértice que ainda toca o cubo depois de todos
+// os cortes indica poliedro ilimitado (ou grande demais para uma caixa útil).
+constexpr double HULL_EXTENT = 1e8;
+
+// Tolerância dos cortes: vértices sobre o plano contam como dentro
+constexpr double HULL_TOLERANCE = 1e-9;
+
+double planeDistance(const Plane& plane, const Point3d& p) {
+    return plane.a * p.x + plane.b * p.y + plane.c * p.z + plane.d;
+}
+
+// Ordenar os pontos da nova face pelo ângulo em torno do centroide
+void sortAroundNormal(Polygon3d& points, const Plane& plane) {
+    Point3d c{ 0, 0, 0 };
+    for (const Point3d& p : points) { c.x += p.x; c.y += p.y; c.z += p.z; }
+    c.x /= points.size(); c.y /= points.size(); c.z /= points.size();
+
+    // Base (u, v) do plano: u perpendicular à normal, v = n × u
+    double nx = plane.a, ny = plane.b, nz = plane.c;
+    double ux, uy, uz;
+    if (std::fabs(nx) < std::fabs(ny)) { ux = 0; uy = nz; uz = -ny; }
+    else { ux = -nz; uy = 0; uz = nx; }
+    double vx = ny * uz - nz * uy, vy = nz * ux - nx * uz, vz = nx * uy - ny * ux;
+
+    auto angle = [&](const Point3d& p) {
+        double dx = p.x - c.x, dy = p.y - c.y, dz = p.z - c.z;
+        return std::atan2(dx * vx + dy * vy + dz * vz, dx * ux + dy * uy + dz * uz);
+    };
+    std::sort(points.begin(), points.end(),
+              [&](const Point3d& a, const Point3d& b) { return angle(a) < angle(b); });
+}
+
+// Cortar o politopo convexo (lista de faces) pelo semi-espaço distance <= 0
+// (Sutherland-Hodgman em cada face); os pontos do corte formam a nova face
+void clipPolytope(std::vector<Polygon3d>& faces, const Plane& plane) {
+    std::vector<Polygon3d> clipped;
+    clipped.reserve(faces.size() + 1);
+    Polygon3d cap;
+
+    for (const Polygon3d& face : faces) {
+        Polygon3d out;
+        const size_t n = face.size();
+        for (size_t i = 0; i < n; i++) {
+            const Point3d& p = face[i];
+            const Point3d& q = face[(i + 1) % n];
+            double dp = planeDistance(plane, p);
+            double dq = planeDistance(plane, q);
+            if (dp <= HULL_TOLERANCE) {
+                out.push_back(p);
+                if (dp >= -HULL_TOLERANCE) cap.push_back(p);
+            }
+            if ((dp < -HULL_TOLERANCE && dq > HULL_TOLERANCE) ||
+                (dp > HULL_TOLERANCE && dq < -HULL_TOLERANCE)) {
+                double t = dp / (dp - dq);
+                Point3d r{ p.x + (q.x - p.x) * t, p.y + (q.y - p.y) * t, p.z + (q.z - p.z) * t };
+                out.push_back(r);
+                cap.push_back(r);
+            }
+        }
+        if (out.size() >= 3) clipped.push_back(std::move(out));
+    }
+
+    if (cap.size() >= 3) {
+        sortAroundNormal(cap, plane);
+        clipped.push_back(std::move(cap));
+    }
+    faces.swap(clipped);
+}
+
+// Caixa de um poliedro pelos vértices reais: o cubo de meia-aresta
+// HULL_EXTENT cortado por cada face. O(faces²), pois cada corte percorre as
+// arestas já existentes. Inválida se vazio ou ilimitado.
+AABB polyhedronBounds(const std::vector<Plane>& planes) {
+    AABB box;
+    if (planes.size() < 4) return box;
+
+    const double e = HULL_EXTENT;
+    const Point3d corner[8] = {
+        { -e, -e, -e }, { e, -e, -e }, { e, e, -e }, { -e, e, -e },
+        { -e, -e, e },  { e, -e, e },  { e, e, e },  { -e, e, e }
+    };
+    std::vector<Polygon3d> faces = {
+        { corner[0], corner[3], corner[2], corner[1] }, { corner[4], corner[5], corner[6], corner[7] },
+        { corner[0], corner[1], corner[5], corner[4] }, { corner[3], corner[7], corner[6], corner[2] },
+        { corner[0], corner[4], corner[7], corner[3] }, { corner[1], corner[2], corner[6], corner[5] }
+    };
+
+    for (const Plane& plane : planes) {
+        clipPolytope(faces, plane);
+        if (faces.empty()) return box;
+    }
+
+    const double limit = e * 0.5;
+    for (const Polygon3d& face : faces) {
+        for (const Point3d& p : face) {
+            if (std::fabs(p.x) >= limit || std::fabs(p.y) >= limit || std::fabs(p.z) >= limit) {
+                return AABB();
+            }
+            box.expand(Vec3(p.x, p.y, p.z));
+        }
+    }
+    return box;
+}
+
+// Interseção de duas caixas; caixa inválida significa "sem limite"
+AABB clipBounds(const AABB& a, const AABB& b) {
+    if (!a.valid()) return b;
+    if (!b.valid()) return a;
+    AABB box;
+    box.min = Vec3(std::max(a.min.x, b.min.x), std::max(a.min.y, b.min.y), std::max(a.min.z, b.min.z));
+    box.max = Vec3(std::min(a.max.x, b.max.x), std::min(a.max.y, b.max.y), std::min(a.max.z, b.max.z));
+    return box;
+}
+
+// Caixa de uma quádrica fechada (elipsoide). Com f(p) = pᵀMp + 2bᵀp + J e M
+// definida, f(p) = (p-c)ᵀM(p-c) + f(c) com c = -M⁻¹b; a superfície é o
+// elipsoide de meia-extensão sqrt(-f(c) · (M⁻¹)ᵢᵢ) em cada eixo.
+AABB ellipsoidBounds(const QuadricData& q) {
+    AABB box;
+
+    // Em double mesmo no build float: o determinante perde precisão rápido
+    double s = q.A < 0 ? -1.0 : 1.0;
+    double a = s * q.A, b = s * q.B, c = s * q.C;
+    double d = s * q.D * 0.5, e = s * q.E * 0.5, f = s * q.F * 0.5;
+    double g = s * q.G * 0.5, h = s * q.H * 0.5, i = s * q.I * 0.5, j = s * q.J;
+
+    // Critério de Sylvester: M positiva definida
+    double minor2 = a * b - d * d;
+    double det = a * (b * c - f * f) - d * (d * c - f * e) + e * (d * f - b * e);
+    if (a <= 0 || minor2 <= 0 || det <= 0) return box;
+
+    // Inversa pela adjunta (M simétrica)
+    double inv[3][3] = {
+        { (b * c - f * f) / det, (e * f - d * c) / det, (d * f - b * e) / det },
+        { (e * f - d * c) / det, (a * c - e * e) / det, (d * e - a * f) / det },
+        { (d * f - b * e) / det, (d * e - a * f) / det, minor2 / det }
+    };
+    double cx = -(inv[0][0] * g + inv[0][1] * h + inv[0][2] * i);
+    double cy = -(inv[1][0] * g + inv[1][1] * h + inv[1][2] * i);
+    double cz = -(inv[2][0] * g + inv[2][1] * h + inv[2][2] * i);
+    double k = j + g * cx + h * cy + i * cz;
+    if (k >= 0) return box; // Vazio ou um ponto
+
+    // Folga relativa para o arredondamento das interseções na borda
+    const double margin = 1.0 + 1e-6;
+    Vec3 center(cx, cy, cz);
+    Vec3 half(std::sqrt(-k * inv[0][0]) * margin, std::sqrt(-k * inv[1][1]) * margin,
+              std::sqrt(-k * inv[2][2]) * margin);
+    box.expand(center - half);
+    box.expand(center + half);
+    return box;
+}
+
+// Caixa de uma quádrica: elipsoide e/ou volumes de corte limitados
+AABB quadricBounds(const QuadricData& q) {
+    AABB box = ellipsoidBounds(q);
+    box = clipBounds(box, q.clipBox);
+    if (!q.clipPlanes.empty()) box = clipBounds(box, polyhedronBounds(q.clipPlanes));
+    return box;
+}
+
+// Recalcular a caixa de um nó a partir dos filhos ou dos objetos da folha
+void updateNodeBounds(const std::vector<BVHNode>& nodes, const std::vector<int>& objectIndices,
+                      BVHNode& node, const std::vector<AABB>& objectBounds) {
+    node.bounds = AABB();
+    if (node.count > 0) {
+        for (int i = node.first; i < node.first + node.count; i++) {
+            node.bounds.expand(objectBounds[objectIndices[i]]);
+        }
+    } else {
+        node.bounds.expand(nodes[node.left].bounds);
+        node.bounds.expand(nodes[node.right].bounds);
+    }
+}
+
+// Acrescentar uma sub-árvore construída à parte, corrigindo os índices dos
+// filhos; devolve o índice da raiz dela
+int appendSubtree(std::vector<BVHNode>& nodes, const std::vector<BVHNode>& subtree) {
+    const int offset = static_cast<int>(nodes.size());
+    for (BVHNode node : subtree) {
+        if (node.count == 0) {
+            node.left += offset;
+            node.right += offset;
+        }
+        nodes.push_back(node);
+    }
+    return offset;
+}
+
+// Construção recursiva por divisão na mediana do eixo mais longo. Nos
+// 'splitLevels' níveis de cima, as metades de nós grandes são construídas em
+// paralelo em vetores próprios (faixas disjuntas de objectIndices) e
+// concatenadas em pré-ordem: mesma árvore, com os mesmos índices, da
+// construção serial.
+int buildRecursive(std::vector<BVHNode>& nodes, std::vector<int>& objectIndices,
+                   const std::vector<AABB>& objectBounds, int first, int count,
+                   int splitLevels) {
+    int nodeIdx = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+
+    AABB centroids;
+    for (int i = first; i < first + count; i++) {
+        centroids.expand(objectBounds[objectIndices[i]].center());
+    }
+
+    if (count <= MAX_LEAF_SIZE) {
+        nodes[nodeIdx].first = first;
+        nodes[nodeIdx].count = count;
+        updateNodeBounds(nodes, objectIndices, nodes[nodeIdx], objectBounds);
+        return nodeIdx;
+    }
+
+    Vec3 e = centroids.extent();
+    int axis = (e.x > e.y && e.x > e.z) ? 0 : (e.y > e.z ? 1 : 2);
+    auto key = [&](int idx) {
+        Vec3 c = objectBounds[idx].center();
+        return axis == 0 ? c.x : (axis == 1 ? c.y : c.z);
+    };
+
+    int mid = first + count / 2;
+    std::nth_element(objectIndices.begin() + first,
+                     objectIndices.begin() + mid,
+                     objectIndices.begin() + first + count,
+                     [&](int a, int b) { return key(a) < key(b); });
+
+    int left, right;
+    if (splitLevels > 0 && count >= PARALLEL_BUILD_MIN) {
+        std::vector<BVHNode> leftNodes, rightNodes;
+        leftNodes.reserve(2 * static_cast<size_t>(mid - first));
+        rightNodes.reserve(2 * static_cast<size_t>(first + count - mid));
+        TaskGroup group;
+        group.run([&] {
+            buildRecursive(leftNodes, objectIndices, objectBounds, first, mid - first,
+                           splitLevels - 1);
+        });
+        buildRecursive(rightNodes, objectIndices, objectBounds, mid, first + count - mid,
+                       splitLevels - 1);
+        group.wait();
+        left = appendSubtree(nodes, leftNodes);
+        right = appendSubtree(nodes, rightNodes);
+    } else {
+        left = buildRecursive(nodes, objectIndices, objectBounds, first, mid - first, 0);
+        right = buildRecursive(nodes, objectIndices, objectBounds, mid, first + count - mid, 0);
+    }
+
+    nodes[nodeIdx].left = left;
+    nodes[nodeIdx].right = right;
+    updateNodeBounds(nodes, objectIndices, nodes[nodeIdx], objectBounds);
+    return nodeIdx;
+}
+
+// Caixas de todos os objetos, em blocos no pool (poliedros custam O(faces²))
+std::vector<AABB> collectBounds(const Scene& scene) {
+    const int count = static_cast<int>(scene.objects.size());
+    std::vector<AABB> bounds(count);
+    const int chunks = (count + BOUNDS_CHUNK - 1) / BOUNDS_CHUNK;
+    ThreadPool::global().parallelFor(chunks, [&](int c) {
+        const int end = std::min(count, (c + 1) * BOUNDS_CHUNK);
+        for (int i = c * BOUNDS_CHUNK; i < end; i++) bounds[i] = computeBounds(scene.objects[i]);
+    });
+    return bounds;
+}
+
+} // namespace anônimo
+
+AABB computeBounds(const Object& obj) {
+    AABB box;
+
+    switch (obj.type) {
+        case SPHERE: {
+            Vec3 r(obj.sphere.radius, obj.sphere.radius, obj.sphere.radius);
+            box.expand(obj.sphere.center - r);
+            box.expand(obj.sphere.center + r);
+            break;
+        }
+
+        case POLYHEDRON:
+            box = polyhedronBounds(obj.faces);
+            break;
+
+        case TRIANGLE:
+            box.expand(obj.triangle.v0);
+            box.expand(obj.triangle.v1);
+            box.expand(obj.triangle.v2);
+            break;
+
+        case CYLINDER: {
+            const auto& cc = obj.cylinderCone;
+            Vec3 axis = cc.axis.normalize();
+            box.expand(diskBounds(cc.base, axis, cc.radius1));
+            box.expand(diskBounds(cc.base + axis * cc.height, axis, cc.radius1));
+            break;
+        }
+
+        case CONE: {
+            const auto& cc = obj.cylinderCone;
+            Vec3 axis = cc.axis.normalize();
+            box.expand(cc.base);
+            box.expand(diskBounds(cc.base + axis * cc.height, axis, cc.radius1));
+            break;
+        }
+
+        case QUADRIC:
+            // Inválida (ilimitada) se não for elipsoide nem estiver cortada
+            box = quadricBounds(obj.quadric);
+            break;
+    }
+
+    return box;
+}
+
+namespace {
+
+// Topologia da BVH a partir das caixas já guardadas em bvh.objectBounds
+void buildTopology(BVH& bvh) {
+    const std::vector<AABB>& objectBounds = bvh.objectBounds;
+    for (size_t i = 0; i < objectBounds.size(); i++) {
+        if (objectBounds[i].valid()) {
+            bvh.objectIndices.push_back(static_cast<int>(i));
+        } else {
+            bvh.unbounded.push_back(static_cast<int>(i));
+        }
+    }
+
+    if (bvh.objectIndices.empty()) return;
+
+    // Sub-árvores paralelas suficientes para ocupar as threads (cada nível
+    // dividido copia seus nós uma vez a mais); nenhuma com uma thread só
+    const int threads = ThreadPool::global().size() + 1;
+    int splitLevels = 0;
+    while (threads > 1 && (1 << splitLevels) < 2 * threads) splitLevels++;
+
+    bvh.nodes.reserve(2 * bvh.objectIndices.size());
+    buildRecursive(bvh.nodes, bvh.objectIndices, objectBounds, 0,
+                   static_cast<int>(bvh.objectIndices.size()), splitLevels);
+    bvh.buildArea = bvh.nodes[0].bounds.surfaceArea();
+}
+
+} // namespace anônimo
+
+void buildBVH(Scene& scene) {
+    scene.bvh = BVH();
+    scene.bvh.objectBounds = collectBounds(scene);
+    buildTopology(scene.bvh);
+}
+
+void rebuildBVH(Scene& scene) {
+    if (scene.bvh.objectBounds.size() != scene.objects.size()) {
+        buildBVH(scene);
+        return;
+    }
+    std::vector<AABB> objectBounds = std::move(scene.bvh.objectBounds);
+    scene.bvh = BVH();
+    scene.bvh.objectBounds = std::move(objectBounds);
+    buildTopology(scene.bvh);
+}
+
+void refitBVH(Scene& scene, const std::vector<int>& changed) {
+    BVH& bvh = scene.bvh;
+    if (bvh.objectBounds.size() != scene.objects.size()) {
+        bvh.objectBounds = collectBounds(scene);
+    } else {
+        // Geometria estática mantém a caixa calculada na construção
+        for (int idx : changed) bvh.objectBounds[idx] = computeBounds(scene.objects[idx]);
+    }
+    if (bvh.empty()) return;
+
+    // Filhos sempre têm índice maior que o pai: percorrer de trás para frente
+    for (int i = static_cast<int>(bvh.nodes.size()) - 1; i >= 0; i--) {
+        updateNodeBounds(bvh.nodes, bvh.objectIndices, bvh.nodes[i], bvh.objectBounds);
+    }
+}
+
+bool intersectAABB(const Ray& ray, const Vec3& invDir, const AABB& box, Real tMax) {
+    Real t1 = (box.min.x - ray.origin.x) * invDir.x;
+    Real t2 = (box.max.x - ray.origin.x) * invDir.x;
+    Real tNear = std::min(t1, t2);
+    Real tFar = std::max(t1, t2);
+
+    t1 = (box.min.y - ray.origin.y) * invDir.y;
+    t2 = (box.max.y - ray.origin.y) * invDir.y;
+    tNear = std::max(tNear, std::min(t1, t2));
+    tFar = std::min(tFar, std::max(t1, t2));
+
+    t1 = (box.min.z - ray.origin.z) * invDir.z;
+    t2 = (box.max.z - ray.origin.z) * invDir.z;
+    tNear = std::max(tNear, std::min(t1, t2));
+    tFar = std::min(tFar, std::max(t1, t2));
+
+    return tFar >= std::max(tNear, Real(0)) && tNear < tMax;
+}
@@ -0,0 +1,59 @@
+// src/camera.cpp
+#include "../include/camera.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+Camera sceneCamera(const Scene& scene, double aperture, double focusDist) {
+    Camera cam;
+    cam.eye = scene.eye;
+    cam.lookAt = scene.lookAt;
+    cam.up = scene.up;
+    cam.fovy = scene.fovy;
+    cam.aperture = aperture;
+    cam.focusDist = focusDist;
+    return cam;
+}
+
+bool loadCameras(const std::string& filename, double aperture, double focusDist,
+                 std::vector<Camera>& cameras) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Erro ao abrir câmeras: " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        std::istringstream in(line);
+        std::string keyword;
+        if (!(in >> keyword) || keyword[0] == '#') continue;
+
+        Camera cam;
+        cam.aperture = aperture;
+        cam.focusDist = focusDist;
+        if (keyword != "camera" ||
+            !(in >> cam.eye.x >> cam.eye.y >> cam.eye.z
+                 >> cam.lookAt.x >> cam.lookAt.y >> cam.lookAt.z
+                 >> cam.up.x >> cam.up.y >> cam.up.z >> cam.fovy)) {
+            std::cerr << "Câmera inválida na linha " << lineNumber << ": " << filename << std::endl;
+            return false;
+        }
+
+        double a, f;
+        if (in >> a >> f) {
+            cam.aperture = a;
+            cam.focusDist = f;
+        }
+
+        cameras.push_back(cam);
+    }
+
+    if (cameras.empty()) {
+        std::cerr << "Nenhuma câmera em " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,191 @@
+// src/denoise.cpp
+#include "../include/denoise.hpp"
+#include "../include/threadpool.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Núcleo B3-spline 1D
+constexpr float KERNEL[5] = { 1.0f / 16, 1.0f / 4, 3.0f / 8, 1.0f / 4, 1.0f / 16 };
+constexpr float VARIANCE_EPS = 1e-6f;
+
+// Raio da janela de estimativa da variância (7x7, como no SVGF)
+constexpr int VARIANCE_RADIUS = 3;
+
+// Piso do desvio-padrão: um nível de 8 bits. Pixels com variância estimada
+// nula ainda se misturam com vizinhos que diferem menos que isso.
+constexpr float VARIANCE_FLOOR = (1.0f / 255.0f) * (1.0f / 255.0f);
+
+// exp(-x) aproximado por (1 + x/16)^-16: sem desvios, vetorizável
+inline float expNeg(float x) {
+    float t = 1.0f + std::min(x, 64.0f) * (1.0f / 16.0f);
+    t *= t; t *= t; t *= t; t *= t;
+    return 1.0f / t;
+}
+
+// Planos de entrada/saída de um passo
+struct Planes {
+    std::vector<float> rgb[3];
+    std::vector<float> variance;
+};
+
+// Acumuladores de uma linha
+struct RowSums {
+    std::vector<float> w, rgb[3], variance;
+
+    void reset(int width) {
+        w.assign(width, 0.0f);
+        variance.assign(width, 0.0f);
+        for (int c = 0; c < 3; c++) rgb[c].assign(width, 0.0f);
+    }
+};
+
+// Um passo à-trous sobre a linha y (espaçamento 'step' entre amostras do núcleo)
+void filterRow(int y, int step, const Planes& in, Planes& out, const AuxBuffers& aux,
+               const DenoiseParams& params, RowSums& sums) {
+    const int w = aux.width;
+    const int h = aux.height;
+    const float sigmaColor2 = params.sigmaColor * params.sigmaColor;
+    const float invSigmaNormal = 1.0f / params.sigmaNormal;
+    const float invSigmaAlbedo2 = 1.0f / (params.sigmaAlbedo * params.sigmaAlbedo);
+
+    sums.reset(w);
+    const int row = y * w;
+
+    for (int ky = 0; ky < 5; ky++) {
+        int yy = y + (ky - 2) * step;
+        if (yy < 0 || yy >= h) continue;
+
+        for (int kx = 0; kx < 5; kx++) {
+            const int dx = (kx - 2) * step;
+            const int off = (ky - 2) * step * w + dx;
+            const int x0 = std::max(0, -dx);
+            const int x1 = std::min(w, w - dx);
+            const float tap = KERNEL[kx] * KERNEL[ky];
+            const int dist = std::max(std::abs(kx - 2), std::abs(ky - 2)) * step;
+            const float invDepth = 1.0f / (params.sigmaDepth * static_cast<float>(dist + 1));
+
+            const float* __restrict ir = in.rgb[0].data();
+            const float* __restrict ig = in.rgb[1].data();
+            const float* __restrict ib = in.rgb[2].data();
+            const float* __restrict iv = in.variance.data();
+            const float* __restrict nx = aux.normal[0].data();
+            const float* __restrict ny = aux.normal[1].data();
+            const float* __restrict nz = aux.normal[2].data();
+            const float* __restrict ar = aux.albedo[0].data();
+            const float* __restrict ag = aux.albedo[1].data();
+            const float* __restrict ab = aux.albedo[2].data();
+            const float* __restrict z = aux.depth.data();
+            float* __restrict sw = sums.w.data();
+            float* __restrict sr = sums.rgb[0].data();
+            float* __restrict sg = sums.rgb[1].data();
+            float* __restrict sb = sums.rgb[2].data();
+            float* __restrict sv = sums.variance.data();
+
+            // Laço contíguo e sem desvios: vetorizado pelo compilador
+            for (int x = x0; x < x1; x++) {
+                const int p = row + x;
+                const int q = p + off;
+
+                float dr = ir[p] - ir[q], dg = ig[p] - ig[q], db = ib[p] - ib[q];
+                float dColor = (dr*dr + dg*dg + db*db) /
+                               (sigmaColor2 * (iv[p] + iv[q]) + VARIANCE_EPS);
+
+                float ex = nx[p] - nx[q], ey = ny[p] - ny[q], ez = nz[p] - nz[q];
+                float dNormal = 0.5f * (ex*ex + ey*ey + ez*ez) * invSigmaNormal;
+
+                float dDepth = std::fabs(z[p] - z[q]) / (std::fabs(z[p]) + 1e-3f) * invDepth;
+
+                float er = ar[p] - ar[q], eg = ag[p] - ag[q], eb = ab[p] - ab[q];
+                float dAlbedo = (er*er + eg*eg + eb*eb) * invSigmaAlbedo2;
+
+                float weight = tap * expNeg(dColor + dNormal + dDepth + dAlbedo);
+
+                sw[x] += weight;
+                sr[x] += weight * ir[q];
+                sg[x] += weight * ig[q];
+                sb[x] += weight * ib[q];
+                sv[x] += weight * weight * iv[q];
+            }
+        }
+    }
+
+    // O tap central tem peso > 0, então w > 0
+    for (int x = 0; x < w; x++) {
+        float inv = 1.0f / sums.w[x];
+        out.rgb[0][row + x] = sums.rgb[0][x] * inv;
+        out.rgb[1][row + x] = sums.rgb[1][x] * inv;
+        out.rgb[2][row + x] = sums.rgb[2][x] * inv;
+        out.variance[row + x] = sums.variance[x] * inv * inv;
+    }
+}
+
+// Variância estimada pela vizinhança (2r+1)x(2r+1). Com 4 amostras a
+// estimativa por pixel erra por ordens de grandeza: zera quando as amostras
+// coincidem por acaso (xadrez distante, desfoque). A média é feita sobre o
+// desvio-padrão, não a variância: numa borda nítida os poucos pixels de
+// variância alta não contaminam os vizinhos lisos, que continuam preservados.
+std::vector<float> poolVariance(const std::vector<float>& variance, int w, int h, int r) {
+    std::vector<float> rows(variance.size()), out(variance.size());
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            const int x0 = std::max(0, x - r), x1 = std::min(w - 1, x + r);
+            float sum = 0.0f;
+            for (int xx = x0; xx <= x1; xx++) sum += std::sqrt(variance[y * w + xx]);
+            rows[y * w + x] = sum / static_cast<float>(x1 - x0 + 1);
+        }
+    }
+    for (int y = 0; y < h; y++) {
+        const int y0 = std::max(0, y - r), y1 = std::min(h - 1, y + r);
+        for (int x = 0; x < w; x++) {
+            float sum = 0.0f;
+            for (int yy = y0; yy <= y1; yy++) sum += rows[yy * w + x];
+            float sigma = sum / static_cast<float>(y1 - y0 + 1);
+            out[y * w + x] = sigma * sigma + VARIANCE_FLOOR;
+        }
+    }
+    return out;
+}
+
+} // namespace anônimo
+
+void AuxBuffers::resize(int w, int h) {
+    width = w;
+    height = h;
+    size_t n = static_cast<size_t>(w) * h;
+    for (int c = 0; c < 3; c++) {
+        albedo[c].assign(n, 0.0f);
+        normal[c].assign(n, 0.0f);
+    }
+    depth.assign(n, 0.0f);
+    variance.assign(n, 0.0f);
+}
+
+void denoise(std::vector<float> color[3], const AuxBuffers& aux, const DenoiseParams& params) {
+    const int h = aux.height;
+    const size_t n = static_cast<size_t>(aux.width) * h;
+
+    Planes current, next;
+    for (int c = 0; c < 3; c++) {
+        current.rgb[c].swap(color[c]);
+        next.rgb[c].resize(n);
+    }
+    current.variance = poolVariance(aux.variance, aux.width, h, VARIANCE_RADIUS);
+    next.variance.resize(n);
+
+    ThreadPool& pool = ThreadPool::global();
+
+    for (int it = 0; it < params.iterations; it++) {
+        const int step = 1 << it;
+
+        pool.parallelFor(h, [&](int y) {
+            thread_local RowSums sums;
+            filterRow(y, step, current, next, aux, params, sums);
+        });
+
+        std::swap(current, next);
+    }
+
+    for (int c = 0; c < 3; c++) color[c].swap(current.rgb[c]);
+}
@@ -0,0 +1,695 @@
+// src/encode.cpp
+#include "../include/encode.hpp"
+#include "../include/threadpool.hpp"
+#include "../include/trace.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <queue>
+
+namespace {
+
+// ---------- Somas de verificação ----------
+
+struct CrcTable {
+    uint32_t entries[256];
+
+    CrcTable() {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[n] = c;
+        }
+    }
+};
+
+uint32_t crc32(const unsigned char* data, size_t size, uint32_t crc = 0) {
+    static const CrcTable table;
+    crc ^= 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+constexpr uint32_t ADLER_MOD = 65521;
+
+uint32_t adler32(const unsigned char* data, size_t size) {
+    uint32_t a = 1, b = 0;
+    while (size > 0) {
+        // Maior bloco sem estouro antes da redução
+        size_t block = std::min(size, size_t(5552));
+        for (size_t i = 0; i < block; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= ADLER_MOD;
+        b %= ADLER_MOD;
+        data += block;
+        size -= block;
+    }
+    return (b << 16) | a;
+}
+
+// Adler-32 da concatenação a partir das somas das partes (como adler32_combine)
+uint32_t adler32Combine(uint32_t adler1, uint32_t adler2, size_t size2) {
+    uint32_t rem = static_cast<uint32_t>(size2 % ADLER_MOD);
+    uint32_t sum1 = adler1 & 0xFFFF;
+    uint32_t sum2 = (rem * sum1) % ADLER_MOD;
+    sum1 += (adler2 & 0xFFFF) + ADLER_MOD - 1;
+    sum2 += (adler1 >> 16) + (adler2 >> 16) + ADLER_MOD - rem;
+    if (sum1 >= ADLER_MOD) sum1 -= ADLER_MOD;
+    if (sum1 >= ADLER_MOD) sum1 -= ADLER_MOD;
+    if (sum2 >= 2 * ADLER_MOD) sum2 -= 2 * ADLER_MOD;
+    if (sum2 >= ADLER_MOD) sum2 -= ADLER_MOD;
+    return (sum2 << 16) | sum1;
+}
+
+void putBigEndian(std::vector<unsigned char>& out, uint32_t value) {
+    out.push_back(static_cast<unsigned char>(value >> 24));
+    out.push_back(static_cast<unsigned char>(value >> 16));
+    out.push_back(static_cast<unsigned char>(value >> 8));
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+// ---------- Deflate (LZ77 + Huffman dinâmico) ----------
+
+// Bits do menos para o mais significativo, como o deflate espera
+class BitWriter {
+private:
+    std::vector<unsigned char>& out;
+    uint64_t buffer = 0;
+    int count = 0;
+
+public:
+    explicit BitWriter(std::vector<unsigned char>& o) : out(o) {}
+
+    void put(uint32_t value, int bits) {
+        buffer |= uint64_t(value) << count;
+        count += bits;
+        while (count >= 8) {
+            out.push_back(static_cast<unsigned char>(buffer));
+            buffer >>= 8;
+            count -= 8;
+        }
+    }
+
+    void align() {
+        if (count > 0) put(0, 8 - count);
+    }
+};
+
+constexpr int WINDOW_SIZE = 32768;
+constexpr int MIN_MATCH = 3;
+constexpr int MAX_MATCH = 258;
+constexpr int HASH_BITS = 15;
+constexpr int MAX_CHAIN = 16;      // Candidatos por posição: velocidade acima de taxa
+
+constexpr int LITERAL_CODES = 286;
+constexpr int DISTANCE_CODES = 30;
+constexpr int LENGTH_CODES = 19;
+
+const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                   35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                   3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                     257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                     8193, 12289, 16385, 24577 };
+const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                     7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// Ordem dos comprimentos do alfabeto de comprimentos no cabeçalho do bloco
+const uint8_t LENGTH_ORDER[LENGTH_CODES] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5,
+                                             11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// Literal (length == 0) ou cópia de 'length' bytes a 'value' de distância
+struct Token {
+    uint16_t length;
+    uint16_t value;
+};
+
+// Símbolos de comprimento e distância por tabela (distâncias acima de 256
+// pela tabela de (d - 1) >> 7, como em zlib)
+struct CodeTables {
+    uint8_t length[MAX_MATCH + 1];
+    uint8_t nearDistance[256];
+    uint8_t farDistance[256];
+
+    CodeTables() {
+        for (int l = MIN_MATCH; l <= MAX_MATCH; l++) {
+            length[l] = static_cast<uint8_t>(
+                std::upper_bound(LENGTH_BASE, LENGTH_BASE + 29, l) - LENGTH_BASE - 1);
+        }
+        for (int d = 1; d <= 256; d++) nearDistance[d - 1] = code(d);
+        for (int k = 2; k < 256; k++) farDistance[k] = code((k << 7) + 1);
+    }
+
+    static uint8_t code(int distance) {
+        return static_cast<uint8_t>(
+            std::upper_bound(DISTANCE_BASE, DISTANCE_BASE + 30, distance) - DISTANCE_BASE - 1);
+    }
+};
+
+const CodeTables& codeTables() {
+    static const CodeTables tables;
+    return tables;
+}
+
+int lengthCode(int length) { return codeTables().length[length]; }
+
+int distanceCode(int distance) {
+    const CodeTables& t = codeTables();
+    return distance <= 256 ? t.nearDistance[distance - 1] : t.farDistance[(distance - 1) >> 7];
+}
+
+uint32_t hash3(const unsigned char* p) {
+    uint32_t v = p[0] | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16);
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// LZ77 guloso com cadeias de hash numa janela circular
+std::vector<Token> findMatches(const unsigned char* data, int size) {
+    std::vector<Token> tokens;
+    tokens.reserve(size / 2 + 16);
+    std::vector<int> head(1 << HASH_BITS, -1);
+    std::vector<int> prev(WINDOW_SIZE, -1);
+
+    auto insert = [&](int i) {
+        uint32_t h = hash3(data + i);
+        prev[i & (WINDOW_SIZE - 1)] = head[h];
+        head[h] = i;
+    };
+
+    int i = 0;
+    while (i < size) {
+        int bestLength = 0, bestDistance = 0;
+        if (i + MIN_MATCH <= size) {
+            const int maxLength = std::min(MAX_MATCH, size - i);
+            int candidate = head[hash3(data + i)];
+            // Entradas mais antigas que a janela já foram sobrescritas no anel
+            for (int chain = 0; chain < MAX_CHAIN && candidate >= 0 &&
+                                i - candidate < WINDOW_SIZE; chain++) {
+                if (data[candidate + bestLength] == data[i + bestLength]) {
+                    int length = 0;
+                    while (length < maxLength && data[candidate + length] == data[i + length]) {
+                        length++;
+                    }
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestDistance = i - candidate;
+                        if (length == maxLength) break;
+                    }
+                }
+                candidate = prev[candidate & (WINDOW_SIZE - 1)];
+            }
+            insert(i);
+        }
+
+        if (bestLength >= MIN_MATCH) {
+            tokens.push_back(Token{ static_cast<uint16_t>(bestLength),
+                                    static_cast<uint16_t>(bestDistance) });
+            for (int k = i + 1; k < i + bestLength && k + MIN_MATCH <= size; k++) insert(k);
+            i += bestLength;
+        } else {
+            tokens.push_back(Token{ 0, data[i] });
+            i++;
+        }
+    }
+    return tokens;
+}
+
+// Comprimentos de Huffman limitados a maxBits: se a árvore passar do limite,
+// as frequências caem à metade (sem zerar) e ela é refeita
+std::vector<uint8_t> huffmanLengths(const std::vector<uint32_t>& frequencies, int maxBits) {
+    const int n = static_cast<int>(frequencies.size());
+    std::vector<uint8_t> lengths(n, 0);
+    std::vector<uint32_t> f(frequencies);
+
+    for (;;) {
+        using Item = std::pair<uint64_t, int>;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+        std::vector<int> symbols, parent;
+        for (int s = 0; s < n; s++) {
+            if (f[s] == 0) continue;
+            heap.push(Item(f[s], static_cast<int>(symbols.size())));
+            symbols.push_back(s);
+            parent.push_back(-1);
+        }
+        if (symbols.empty()) return lengths;
+        if (symbols.size() == 1) {
+            lengths[symbols[0]] = 1;
+            return lengths;
+        }
+
+        while (heap.size() > 1) {
+            Item a = heap.top(); heap.pop();
+            Item b = heap.top(); heap.pop();
+            int node = static_cast<int>(parent.size());
+            parent.push_back(-1);
+            parent[a.second] = node;
+            parent[b.second] = node;
+            heap.push(Item(a.first + b.first, node));
+        }
+
+        int longest = 0;
+        for (size_t k = 0; k < symbols.size(); k++) {
+            int depth = 0;
+            for (int p = static_cast<int>(k); parent[p] >= 0; p = parent[p]) depth++;
+            lengths[symbols[k]] = static_cast<uint8_t>(depth);
+            longest = std::max(longest, depth);
+        }
+        if (longest <= maxBits) return lengths;
+        for (auto& x : f) {
+            if (x > 0) x = (x + 1) / 2;
+        }
+    }
+}
+
+// Códigos canônicos, já com os bits invertidos para o BitWriter
+std::vector<uint16_t> canonicalCodes(const std::vector<uint8_t>& lengths) {
+    int counts[16] = { 0 };
+    for (uint8_t length : lengths) {
+        if (length > 0) counts[length]++;
+    }
+    int next[16] = { 0 };
+    int code = 0;
+    for (int bits = 1; bits < 16; bits++) {
+        code = (code + counts[bits - 1]) << 1;
+        next[bits] = code;
+    }
+
+    std::vector<uint16_t> codes(lengths.size(), 0);
+    for (size_t s = 0; s < lengths.size(); s++) {
+        int length = lengths[s];
+        if (length == 0) continue;
+        int c = next[length]++;
+        int reversed = 0;
+        for (int b = 0; b < length; b++) reversed |= ((c >> b) & 1) << (length - 1 - b);
+        codes[s] = static_cast<uint16_t>(reversed);
+    }
+    return codes;
+}
+
+// Um bloco com códigos de Huffman próprios (BTYPE = 2), não final
+void writeDynamicBlock(const std::vector<Token>& tokens, BitWriter& bits) {
+    std::vector<uint32_t> literalFreq(LITERAL_CODES, 0), distanceFreq(DISTANCE_CODES, 0);
+    for (const Token& t : tokens) {
+        if (t.length == 0) {
+            literalFreq[t.value]++;
+        } else {
+            literalFreq[257 + lengthCode(t.length)]++;
+            distanceFreq[distanceCode(t.value)]++;
+        }
+    }
+    literalFreq[256] = 1;   // Fim de bloco
+
+    std::vector<uint8_t> literalLengths = huffmanLengths(literalFreq, 15);
+    std::vector<uint8_t> distanceLengths = huffmanLengths(distanceFreq, 15);
+    if (std::all_of(distanceLengths.begin(), distanceLengths.end(),
+                    [](uint8_t l) { return l == 0; })) {
+        distanceLengths[0] = 1;   // Decodificadores exigem ao menos um código
+    }
+    std::vector<uint16_t> literalCodes = canonicalCodes(literalLengths);
+    std::vector<uint16_t> distanceCodes = canonicalCodes(distanceLengths);
+
+    int literalCount = LITERAL_CODES;
+    while (literalCount > 257 && literalLengths[literalCount - 1] == 0) literalCount--;
+    int distanceCount = DISTANCE_CODES;
+    while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0) distanceCount--;
+
+    // Comprimentos dos dois alfabetos em sequência, com as repetições 16/17/18
+    std::vector<uint8_t> all(literalLengths.begin(), literalLengths.begin() + literalCount);
+    all.insert(all.end(), distanceLengths.begin(), distanceLengths.begin() + distanceCount);
+
+    std::vector<std::pair<uint8_t, uint8_t>> runs;   // (símbolo, bits extras)
+    for (size_t i = 0; i < all.size();) {
+        uint8_t length = all[i];
+        size_t run = 1;
+        while (i + run < all.size() && all[i + run] == length) run++;
+
+        if (length == 0 && run >= 3) {
+            size_t r = std::min<size_t>(run, 138);
+            if (r >= 11) runs.emplace_back(18, static_cast<uint8_t>(r - 11));
+            else runs.emplace_back(17, static_cast<uint8_t>(r - 3));
+            i += r;
+        } else if (length != 0 && run >= 4) {
+            size_t r = std::min<size_t>(run - 1, 6);
+            runs.emplace_back(length, 0);
+            runs.emplace_back(16, static_cast<uint8_t>(r - 3));
+            i += 1 + r;
+        } else {
+            runs.emplace_back(length, 0);
+            i++;
+        }
+    }
+
+    std::vector<uint32_t> lengthFreq(LENGTH_CODES, 0);
+    for (const auto& r : runs) lengthFreq[r.first]++;
+    std::vector<uint8_t> lengthLengths = huffmanLengths(lengthFreq, 7);
+    std::vector<uint16_t> lengthCodes = canonicalCodes(lengthLengths);
+    int lengthCount = LENGTH_CODES;
+    while (lengthCount > 4 && lengthLengths[LENGTH_ORDER[lengthCount - 1]] == 0) lengthCount--;
+
+    bits.put(0, 1);     // Não final: o fim do fluxo é um bloco vazio à parte
+    bits.put(2, 2);
+    bits.put(literalCount - 257, 5);
+    bits.put(distanceCount - 1, 5);
+    bits.put(lengthCount - 4, 4);
+    for (int k = 0; k < lengthCount; k++) bits.put(lengthLengths[LENGTH_ORDER[k]], 3);
+
+    for (const auto& r : runs) {
+        bits.put(lengthCodes[r.first], lengthLengths[r.first]);
+        if (r.first == 16) bits.put(r.second, 2);
+        else if (r.first == 17) bits.put(r.second, 3);
+        else if (r.first == 18) bits.put(r.second, 7);
+    }
+
+    for (const Token& t : tokens) {
+        if (t.length == 0) {
+            bits.put(literalCodes[t.value], literalLengths[t.value]);
+            continue;
+        }
+        int lc = lengthCode(t.length);
+        bits.put(literalCodes[257 + lc], literalLengths[257 + lc]);
+        bits.put(t.length - LENGTH_BASE[lc], LENGTH_EXTRA[lc]);
+        int dc = distanceCode(t.value);
+        bits.put(distanceCodes[dc], distanceLengths[dc]);
+        bits.put(t.value - DISTANCE_BASE[dc], DISTANCE_EXTRA[dc]);
+    }
+    bits.put(literalCodes[256], literalLengths[256]);
+}
+
+// Trecho de fluxo deflate independente: blocos próprios e um bloco
+// armazenado vazio (sync flush) que termina alinhado em byte, então trechos
+// de faixas diferentes podem ser concatenados
+void deflateSegment(const unsigned char* data, int size, std::vector<unsigned char>& out) {
+    BitWriter bits(out);
+    writeDynamicBlock(findMatches(data, size), bits);
+    bits.put(0, 1);
+    bits.put(0, 2);
+    bits.align();
+    bits.put(0x0000, 16);
+    bits.put(0xFFFF, 16);
+}
+
+// Bloco armazenado vazio e final: fecha o fluxo depois dos trechos
+const unsigned char DEFLATE_END[] = { 0x01, 0x00, 0x00, 0xFF, 0xFF };
+
+void writeChunk(std::vector<unsigned char>& out, const char* type,
+                const unsigned char* data, size_t size) {
+    putBigEndian(out, static_cast<uint32_t>(size));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    putBigEndian(out, crc32(out.data() + start, size + 4));
+}
+
+// ---------- PNG ----------
+
+int paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+constexpr int PNG_FILTERS = 5;     // None, Sub, Up, Average, Paeth
+constexpr int BYTES_PER_PIXEL = 3;
+
+// Preditor do filtro f a partir dos vizinhos esquerdo (a), acima (b) e acima à esquerda (c)
+inline int predict(int f, int a, int b, int c) {
+    switch (f) {
+        case 1: return a;
+        case 2: return b;
+        case 3: return (a + b) / 2;
+        case 4: return paeth(a, b, c);
+        default: return 0;
+    }
+}
+
+inline int residualCost(int value, int predictor) {
+    return std::abs(static_cast<int>(static_cast<signed char>(value - predictor)));
+}
+
+// Linha com o filtro de menor soma de resíduos (heurística usual), custos dos
+// cinco numa passada. Sem a linha anterior (início da faixa, talvez ainda não
+// renderizada) só None e Sub.
+void filterRow(const unsigned char* row, const unsigned char* prev, int bytes, unsigned char* out) {
+    long cost[PNG_FILTERS] = { 0 };
+    for (int i = 0; i < bytes; i++) {
+        int x = row[i];
+        int a = i >= BYTES_PER_PIXEL ? row[i - BYTES_PER_PIXEL] : 0;
+        cost[0] += residualCost(x, 0);
+        cost[1] += residualCost(x, a);
+        if (!prev) continue;
+        int b = prev[i];
+        int c = i >= BYTES_PER_PIXEL ? prev[i - BYTES_PER_PIXEL] : 0;
+        cost[2] += residualCost(x, b);
+        cost[3] += residualCost(x, (a + b) / 2);
+        cost[4] += residualCost(x, paeth(a, b, c));
+    }
+
+    const int filters = prev ? PNG_FILTERS : 2;
+    int best = 0;
+    for (int f = 1; f < filters; f++) {
+        if (cost[f] < cost[best]) best = f;
+    }
+
+    out[0] = static_cast<unsigned char>(best);
+    for (int i = 0; i < bytes; i++) {
+        int a = i >= BYTES_PER_PIXEL ? row[i - BYTES_PER_PIXEL] : 0;
+        int b = prev ? prev[i] : 0;
+        int c = (prev && i >= BYTES_PER_PIXEL) ? prev[i - BYTES_PER_PIXEL] : 0;
+        out[i + 1] = static_cast<unsigned char>(row[i] - predict(best, a, b, c));
+    }
+}
+
+// ---------- QOI ----------
+
+constexpr unsigned char QOI_OP_INDEX = 0x00;
+constexpr unsigned char QOI_OP_DIFF = 0x40;
+constexpr unsigned char QOI_OP_LUMA = 0x80;
+constexpr unsigned char QOI_OP_RUN = 0xC0;
+constexpr unsigned char QOI_OP_RGB = 0xFE;
+constexpr int QOI_MAX_RUN = 62;
+const unsigned char QOI_END[] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+struct QoiPixel {
+    unsigned char r = 0, g = 0, b = 0, a = 0;
+    bool operator==(const QoiPixel& o) const { return r == o.r && g == o.g && b == o.b && a == o.a; }
+};
+
+int qoiHash(const QoiPixel& p) { return (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) % 64; }
+
+// Faixa independente: o primeiro pixel vai explícito (o decodificador tem
+// outro pixel anterior) e só entradas do índice escritas na própria faixa são
+// referenciadas (o decodificador escreve as mesmas a cada pixel)
+void encodeQoi(const unsigned char* rgb, size_t pixels, std::vector<unsigned char>& out) {
+    QoiPixel index[64];
+    QoiPixel previous;
+    int run = 0;
+
+    for (size_t i = 0; i < pixels; i++) {
+        QoiPixel px;
+        px.r = rgb[i * 3 + 0];
+        px.g = rgb[i * 3 + 1];
+        px.b = rgb[i * 3 + 2];
+        px.a = 255;
+
+        if (i > 0 && px == previous) {
+            if (++run == QOI_MAX_RUN) {
+                out.push_back(static_cast<unsigned char>(QOI_OP_RUN | (run - 1)));
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            out.push_back(static_cast<unsigned char>(QOI_OP_RUN | (run - 1)));
+            run = 0;
+        }
+
+        int h = qoiHash(px);
+        if (index[h] == px) {
+            out.push_back(static_cast<unsigned char>(QOI_OP_INDEX | h));
+        } else {
+            index[h] = px;
+            int dr = static_cast<signed char>(px.r - previous.r);
+            int dg = static_cast<signed char>(px.g - previous.g);
+            int db = static_cast<signed char>(px.b - previous.b);
+            int drg = dr - dg, dbg = db - dg;
+            if (i > 0 && dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                out.push_back(static_cast<unsigned char>(QOI_OP_DIFF | (dr + 2) << 4 |
+                                                         (dg + 2) << 2 | (db + 2)));
+            } else if (i > 0 && dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 &&
+                       dbg >= -8 && dbg <= 7) {
+                out.push_back(static_cast<unsigned char>(QOI_OP_LUMA | (dg + 32)));
+                out.push_back(static_cast<unsigned char>((drg + 8) << 4 | (dbg + 8)));
+            } else {
+                out.push_back(QOI_OP_RGB);
+                out.push_back(px.r);
+                out.push_back(px.g);
+                out.push_back(px.b);
+            }
+        }
+        previous = px;
+    }
+    if (run > 0) out.push_back(static_cast<unsigned char>(QOI_OP_RUN | (run - 1)));
+}
+
+} // namespace anônimo
+
+ImageFormat imageFormatFor(const std::string& filename) {
+    size_t dot = filename.find_last_of('.');
+    size_t slash = filename.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return IMAGE_PPM;
+
+    std::string ext = filename.substr(dot + 1);
+    for (char& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (ext == "qoi") return IMAGE_QOI;
+    if (ext == "png") return IMAGE_PNG;
+    return IMAGE_PPM;
+}
+
+ImageEncoder::ImageEncoder(const HDRImage& img, int w, int h, ImageFormat f,
+                           ToneMap o, double g, int rows)
+    : image(img), width(w), height(h), format(f), op(o), gamma(g),
+      bandRows(std::max(1, rows)) {
+    bandCount = (height + bandRows - 1) / bandRows;
+    bands.resize(bandCount);
+    adlers.assign(bandCount, 1);
+    pendingRows.reset(new std::atomic<int>[bandCount]);
+    claimed.reset(new std::atomic<bool>[bandCount]);
+    for (int b = 0; b < bandCount; b++) {
+        pendingRows[b] = std::min(bandRows, height - b * bandRows);
+        claimed[b] = false;
+    }
+}
+
+void ImageEncoder::encodeBand(int band) {
+    TraceScope scope("saida", "faixa", "faixa", band);
+    const int y0 = band * bandRows;
+    const int y1 = std::min(height, y0 + bandRows);
+    const int stride = width * 3;
+
+    std::vector<unsigned char> rgb(static_cast<size_t>(y1 - y0) * stride);
+    unsigned char* dst = rgb.data();
+    for (int y = y0; y < y1; y++) {
+        for (int x = 0; x < width; x++) {
+            Vec3 color = toneMap(image.average(x, y), op, gamma);
+            *dst++ = toByte(color.x);
+            *dst++ = toByte(color.y);
+            *dst++ = toByte(color.z);
+        }
+    }
+
+    std::vector<unsigned char>& out = bands[band];
+    if (format == IMAGE_QOI) {
+        encodeQoi(rgb.data(), static_cast<size_t>(y1 - y0) * width, out);
+        return;
+    }
+
+    // PNG: linhas filtradas, um trecho deflate e um IDAT próprio
+    const size_t rowBytes = static_cast<size_t>(stride) + 1;
+    std::vector<unsigned char> filtered(rowBytes * (y1 - y0));
+    for (int r = 0; r < y1 - y0; r++) {
+        const unsigned char* row = rgb.data() + static_cast<size_t>(r) * stride;
+        const unsigned char* prev = r > 0 ? row - stride : nullptr;
+        filterRow(row, prev, stride, filtered.data() + r * rowBytes);
+    }
+    adlers[band] = adler32(filtered.data(), filtered.size());
+
+    std::vector<unsigned char> compressed;
+    deflateSegment(filtered.data(), static_cast<int>(filtered.size()), compressed);
+    writeChunk(out, "IDAT", compressed.data(), compressed.size());
+}
+
+void ImageEncoder::claimBand(int band) {
+    if (!claimed[band].exchange(true)) encodeBand(band);
+}
+
+void ImageEncoder::rowsReady(int y0, int y1) {
+    y0 = std::max(y0, 0);
+    y1 = std::min(y1, height);
+    for (int b = y0 / bandRows; y0 < y1 && b < bandCount; b++) {
+        int first = std::max(y0, b * bandRows);
+        int last = std::min(y1, (b + 1) * bandRows);
+        if (first >= last) continue;
+        int rows = last - first;
+        if (pendingRows[b].fetch_sub(rows) == rows) claimBand(b);
+    }
+}
+
+std::vector<unsigned char> ImageEncoder::finish() {
+    // Faixas que a renderização não completou (ou nenhuma, sem rowsReady)
+    ThreadPool::global().parallelFor(bandCount, [&](int b) { claimBand(b); });
+
+    std::vector<unsigned char> out;
+    size_t total = 0;
+    for (const auto& band : bands) total += band.size();
+    out.reserve(total + 64);
+
+    if (format == IMAGE_QOI) {
+        const char magic[] = { 'q', 'o', 'i', 'f' };
+        out.insert(out.end(), magic, magic + 4);
+        putBigEndian(out, static_cast<uint32_t>(width));
+        putBigEndian(out, static_cast<uint32_t>(height));
+        out.push_back(3);   // RGB
+        out.push_back(0);   // sRGB com alfa linear
+        for (const auto& band : bands) out.insert(out.end(), band.begin(), band.end());
+        out.insert(out.end(), QOI_END, QOI_END + sizeof(QOI_END));
+        return out;
+    }
+
+    const unsigned char signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.insert(out.end(), signature, signature + sizeof(signature));
+
+    std::vector<unsigned char> header;
+    putBigEndian(header, static_cast<uint32_t>(width));
+    putBigEndian(header, static_cast<uint32_t>(height));
+    header.push_back(8);    // Bits por canal
+    header.push_back(2);    // RGB
+    header.push_back(0);    // Deflate
+    header.push_back(0);    // Filtros adaptativos
+    header.push_back(0);    // Sem entrelaçamento
+    writeChunk(out, "IHDR", header.data(), header.size());
+
+    // Cabeçalho zlib (deflate, janela de 32 KiB) num IDAT próprio
+    const unsigned char zlibHeader[] = { 0x78, 0x01 };
+    writeChunk(out, "IDAT", zlibHeader, sizeof(zlibHeader));
+
+    uint32_t adler = 1;
+    const size_t rowBytes = static_cast<size_t>(width) * 3 + 1;
+    for (int b = 0; b < bandCount; b++) {
+        out.insert(out.end(), bands[b].begin(), bands[b].end());
+        int rows = std::min(bandRows, height - b * bandRows);
+        adler = adler32Combine(adler, adlers[b], rowBytes * rows);
+    }
+
+    std::vector<unsigned char> trailer(DEFLATE_END, DEFLATE_END + sizeof(DEFLATE_END));
+    putBigEndian(trailer, adler);
+    writeChunk(out, "IDAT", trailer.data(), trailer.size());
+    writeChunk(out, "IEND", nullptr, 0);
+    return out;
+}
+
+bool ImageEncoder::save(const std::string& filename) {
+    TraceScope scope("saida", "gravacao");
+    std::vector<unsigned char> bytes = finish();
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Erro ao criar arquivo: " << filename << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(file);
+}
+
+bool writeImage(const std::string& filename, const HDRImage& image, ToneMap op, double gamma) {
+    ImageFormat format = imageFormatFor(filename);
+    TraceScope scope("saida", "gravacao");
+    if (format == IMAGE_PPM) return writePPM(filename, image, op, gamma);
+
+    ImageEncoder encoder(image, image.width, image.height, format, op, gamma);
+    return encoder.save(filename);
+}
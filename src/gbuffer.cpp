@@ -0,0 +1,70 @@
+// src/gbuffer.cpp
+#include "../include/gbuffer.hpp"
+#include "../include/shading.hpp"
+#include <algorithm>
+
+namespace {
+
+// Reproduz shade(): local + kr·reflexão + kt·refração. 'base' é o primeiro nó do pixel.
+Vec3 evaluateNode(const GBufferNode* base, int idx, const Scene& scene) {
+    if (idx == GNODE_NONE) return Vec3(0, 0, 0);
+    if (idx == GNODE_BACKGROUND) return backgroundColor();
+
+    const GBufferNode& node = base[idx];
+    const Finish& finish = scene.finishes[scene.objects[node.objectIdx].finishIdx];
+
+    Vec3 local = ambientTerm(node.baseColor, scene, finish);
+    for (size_t i = 1; i < scene.lights.size(); i++) {
+        if (node.shadowMask & (uint64_t(1) << i)) continue;
+        local = local + directTerm(node.baseColor, node.point, node.normal, node.viewDir,
+                                   scene.lights[i], finish);
+    }
+
+    Vec3 color = local;
+    color = color + evaluateNode(base, node.reflectChild, scene) * finish.kr;
+    color = color + evaluateNode(base, node.refractChild, scene) * finish.kt;
+
+    return color;
+}
+
+} // namespace anônimo
+
+size_t GBuffer::bytes(size_t pixels, int samples, size_t nodeCount) {
+    return nodeCount * sizeof(GBufferNode) +
+           pixels * (sizeof(size_t) + static_cast<size_t>(samples) * sizeof(int));
+}
+
+void GBuffer::reset(size_t pixels, int sampleCount, size_t expectedNodes) {
+    samples = sampleCount;
+    nodes.clear();
+    nodes.reserve(expectedNodes);
+    first.assign(pixels, 0);
+    roots.assign(pixels * static_cast<size_t>(samples), GNODE_NONE);
+}
+
+void GBuffer::clear() {
+    samples = 0;
+    std::vector<GBufferNode>().swap(nodes);
+    std::vector<size_t>().swap(first);
+    std::vector<int>().swap(roots);
+}
+
+void GBuffer::store(size_t pixel, const GBufferPixel& recorded) {
+    // Raízes e primeiro nó são só deste pixel; o vetor de nós é compartilhado
+    std::copy(recorded.roots.begin(), recorded.roots.end(),
+              roots.begin() + static_cast<std::ptrdiff_t>(pixel * samples));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    first[pixel] = nodes.size();
+    nodes.insert(nodes.end(), recorded.nodes.begin(), recorded.nodes.end());
+}
+
+Vec3 GBuffer::relightPixel(size_t pixel, const Scene& scene) const {
+    const GBufferNode* base = nodes.data() + first[pixel];
+    const int* pixelRoots = &roots[pixel * samples];
+    Vec3 color(0, 0, 0);
+    for (int s = 0; s < samples; s++) {
+        color = color + evaluateNode(base, pixelRoots[s], scene);
+    }
+    return color;
+}
@@ -0,0 +1,77 @@
+// src/heatmap.cpp
+#include "../include/heatmap.hpp"
+#include "../include/image.hpp"
+#include <algorithm>
+
+bool parseHeatMetric(const std::string& name, HeatMetric& metric) {
+    if (name == "tests") metric = HEAT_TESTS;
+    else if (name == "rays") metric = HEAT_RAYS;
+    else if (name == "time") metric = HEAT_TIME;
+    else return false;
+    return true;
+}
+
+const char* heatMetricName(HeatMetric metric) {
+    switch (metric) {
+        case HEAT_TESTS: return "testes de interseção";
+        case HEAT_RAYS:  return "raios";
+        case HEAT_TIME:  return "tempo";
+    }
+    return "";
+}
+
+const char* heatMetricUnit(HeatMetric metric) {
+    return metric == HEAT_TIME ? "us" : "";
+}
+
+double heatValue(HeatMetric metric, const RenderStats& stats, double micros) {
+    switch (metric) {
+        case HEAT_TESTS: {
+            uint64_t tests = 0;
+            for (int i = 0; i < OBJECT_TYPE_COUNT; i++) tests += stats.tests[i];
+            return static_cast<double>(tests);
+        }
+        case HEAT_RAYS:
+            return static_cast<double>(stats.totalRays());
+        case HEAT_TIME:
+            return micros;
+    }
+    return 0.0;
+}
+
+Vec3 heatColor(double t) {
+    static const Vec3 stops[] = {
+        Vec3(0.00, 0.00, 0.02),
+        Vec3(0.34, 0.06, 0.43),
+        Vec3(0.87, 0.32, 0.23),
+        Vec3(0.99, 0.80, 0.20),
+        Vec3(1.00, 1.00, 0.85)
+    };
+    const int segments = 4;
+
+    t = std::clamp(t, 0.0, 1.0) * segments;
+    int i = std::min(static_cast<int>(t), segments - 1);
+    double s = t - i;
+    return stops[i] + (stops[i + 1] - stops[i]) * s;
+}
+
+bool writeHeatmap(const std::string& filename, int width, int height,
+                  const std::vector<float>& values, double& scale) {
+    std::vector<float> sorted(values);
+    size_t k = sorted.empty() ? 0 : static_cast<size_t>((sorted.size() - 1) * 0.995);
+    if (!sorted.empty()) std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    scale = sorted.empty() ? 0.0 : sorted[k];
+    if (scale <= 0.0) scale = 1.0;
+
+    HDRImage image;
+    image.resize(width, height);
+    for (size_t pixel = 0; pixel < values.size(); pixel++) {
+        Vec3 color = heatColor(values[pixel] / scale);
+        image.sums[pixel * 3 + 0] = static_cast<float>(color.x);
+        image.sums[pixel * 3 + 1] = static_cast<float>(color.y);
+        image.sums[pixel * 3 + 2] = static_cast<float>(color.z);
+        image.counts[pixel] = 1;
+    }
+
+    return writePPM(filename, image, TONEMAP_CLAMP, 1.0);
+}
@@ -0,0 +1,62 @@
+// src/image.cpp
+#include "../include/image.hpp"
+#include <fstream>
+#include <iostream>
+
+void HDRImage::resize(int w, int h) {
+    width = w;
+    height = h;
+    sums.assign(static_cast<size_t>(w) * h * 3, 0.0f);
+    counts.assign(static_cast<size_t>(w) * h, 0);
+}
+
+Vec3 HDRImage::average(int x, int y) const {
+    size_t pixel = static_cast<size_t>(y) * width + x;
+    if (counts[pixel] == 0) return Vec3(0, 0, 0);
+
+    size_t idx = pixel * 3;
+    return Vec3(sums[idx + 0], sums[idx + 1], sums[idx + 2]) /
+           static_cast<double>(counts[pixel]);
+}
+
+bool writePPM(const std::string& filename, const HDRImage& image, ToneMap op, double gamma) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Erro ao criar arquivo: " << filename << std::endl;
+        return false;
+    }
+
+    file << "P3\n" << image.width << " " << image.height << "\n255\n";
+
+    for (int y = 0; y < image.height; y++) {
+        for (int x = 0; x < image.width; x++) {
+            Vec3 color = toneMap(image.average(x, y), op, gamma);
+            file << static_cast<int>(toByte(color.x)) << " "
+                 << static_cast<int>(toByte(color.y)) << " "
+                 << static_cast<int>(toByte(color.z)) << " ";
+        }
+        file << "\n";
+    }
+
+    file.close();
+    return true;
+}
+
+std::vector<unsigned char> encodePPM(const HDRImage& image, ToneMap op, double gamma) {
+    std::string header = "P6\n" + std::to_string(image.width) + " " +
+                         std::to_string(image.height) + "\n255\n";
+
+    std::vector<unsigned char> bytes(header.begin(), header.end());
+    bytes.reserve(header.size() + static_cast<size_t>(image.width) * image.height * 3);
+
+    for (int y = 0; y < image.height; y++) {
+        for (int x = 0; x < image.width; x++) {
+            Vec3 color = toneMap(image.average(x, y), op, gamma);
+            bytes.push_back(toByte(color.x));
+            bytes.push_back(toByte(color.y));
+            bytes.push_back(toByte(color.z));
+        }
+    }
+
+    return bytes;
+}
@@ -0,0 +1,218 @@
+// src/incremental.cpp
+#include "../include/incremental.hpp"
+#include "../include/bvh.hpp"
+#include <algorithm>
+
+namespace {
+
+bool same(const Vec3& a, const Vec3& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+bool sameCamera(const Scene& a, const Scene& b) {
+    return same(a.eye, b.eye) && same(a.lookAt, b.lookAt) &&
+           same(a.up, b.up) && a.fovy == b.fovy;
+}
+
+bool sameLight(const Light& a, const Light& b) {
+    return same(a.position, b.position) && same(a.color, b.color) &&
+           same(a.attenuation, b.attenuation);
+}
+
+bool samePigment(const Pigment& a, const Pigment& b) {
+    if (a.type != b.type) return false;
+    switch (a.type) {
+        case SOLID:
+            return same(a.color1, b.color1);
+        case CHECKER:
+            return same(a.color1, b.color1) && same(a.color2, b.color2) && a.scale == b.scale;
+        case TEXMAP:
+            return a.texturePath == b.texturePath &&
+                   std::equal(a.p0, a.p0 + 4, b.p0) &&
+                   std::equal(a.p1, a.p1 + 4, b.p1);
+    }
+    return false;
+}
+
+bool sameFinish(const Finish& a, const Finish& b) {
+    return a.ka == b.ka && a.kd == b.kd && a.ks == b.ks && a.alpha == b.alpha &&
+           a.kr == b.kr && a.kt == b.kt && a.ior == b.ior;
+}
+
+bool samePlanes(const std::vector<Plane>& a, const std::vector<Plane>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        const Plane& p = a[i];
+        const Plane& q = b[i];
+        if (p.a != q.a || p.b != q.b || p.c != q.c || p.d != q.d) return false;
+    }
+    return true;
+}
+
+bool sameGeometry(const Object& a, const Object& b) {
+    if (a.type != b.type) return false;
+    switch (a.type) {
+        case SPHERE:
+            return same(a.sphere.center, b.sphere.center) && a.sphere.radius == b.sphere.radius;
+        case POLYHEDRON:
+            return samePlanes(a.faces, b.faces);
+        case TRIANGLE:
+            return same(a.triangle.v0, b.triangle.v0) && same(a.triangle.v1, b.triangle.v1) &&
+                   same(a.triangle.v2, b.triangle.v2);
+        case CYLINDER:
+        case CONE:
+            return same(a.cylinderCone.base, b.cylinderCone.base) &&
+                   same(a.cylinderCone.axis, b.cylinderCone.axis) &&
+                   a.cylinderCone.height == b.cylinderCone.height &&
+                   a.cylinderCone.radius1 == b.cylinderCone.radius1;
+        case QUADRIC: {
+            const auto& p = a.quadric;
+            const auto& q = b.quadric;
+            return p.A == q.A && p.B == q.B && p.C == q.C && p.D == q.D && p.E == q.E &&
+                   p.F == q.F && p.G == q.G && p.H == q.H && p.I == q.I && p.J == q.J &&
+                   same(p.clipBox.min, q.clipBox.min) && same(p.clipBox.max, q.clipBox.max) &&
+                   samePlanes(p.clipPlanes, q.clipPlanes);
+        }
+    }
+    return false;
+}
+
+// Segmento [from, to] engordado por 'margin' cruza a caixa?
+bool segmentMayCross(const Vec3& from, const Vec3& to, const Vec3& margin, const AABB& box) {
+    AABB grown = box;
+    grown.min = grown.min - margin;
+    grown.max = grown.max + margin;
+
+    Vec3 d = to - from;
+    Real len = d.length();
+    if (len < EPSILON) return grown.overlaps(AABB{from, from});
+
+    Ray ray(from, d);
+    Vec3 invDir(1 / ray.direction.x, 1 / ray.direction.y, 1 / ray.direction.z);
+    return intersectAABB(ray, invDir, grown, len);
+}
+
+} // namespace anônimo
+
+SceneDiff diffScenes(const Scene& before, const Scene& after) {
+    SceneDiff diff;
+
+    // Câmera e luzes afetam todos os pixels
+    if (!sameCamera(before, after) ||
+        before.lights.size() != after.lights.size() ||
+        before.pigments.size() != after.pigments.size() ||
+        before.finishes.size() != after.finishes.size() ||
+        before.objects.size() != after.objects.size()) {
+        diff.full = true;
+        return diff;
+    }
+
+    for (size_t i = 0; i < before.lights.size(); i++) {
+        if (!sameLight(before.lights[i], after.lights[i])) {
+            diff.full = true;
+            return diff;
+        }
+    }
+
+    for (size_t i = 0; i < before.objects.size(); i++) {
+        const Object& a = before.objects[i];
+        const Object& b = after.objects[i];
+
+        bool geometry = !sameGeometry(a, b);
+        bool material = a.pigmentIdx != b.pigmentIdx || a.finishIdx != b.finishIdx ||
+                        !samePigment(before.pigments[a.pigmentIdx], after.pigments[b.pigmentIdx]) ||
+                        !sameFinish(before.finishes[a.finishIdx], after.finishes[b.finishIdx]);
+
+        if (!geometry && !material) continue;
+        diff.changedObjects.push_back(static_cast<int>(i));
+
+        if (geometry) {
+            // Nova posição pode ocluir ou refletir em pixels que nunca a tocaram
+            AABB box = computeBounds(b);
+            if (!box.valid()) {
+                diff.full = true;
+                return diff;
+            }
+            diff.newBounds.push_back(box);
+        }
+    }
+
+    return diff;
+}
+
+bool relightable(const std::vector<Light>& lightsBefore, const std::vector<Finish>& finishesBefore,
+                 const std::vector<Light>& lightsAfter, const std::vector<Finish>& finishesAfter) {
+    if (lightsBefore.size() != lightsAfter.size() ||
+        finishesBefore.size() != finishesAfter.size()) {
+        return false;
+    }
+
+    // Posições das luzes definem os raios de sombra
+    for (size_t i = 0; i < lightsBefore.size(); i++) {
+        if (!same(lightsBefore[i].position, lightsAfter[i].position)) return false;
+    }
+
+    // kr/kt podem mudar de valor, mas não ligar/desligar raios secundários
+    for (size_t i = 0; i < finishesBefore.size(); i++) {
+        const Finish& a = finishesBefore[i];
+        const Finish& b = finishesAfter[i];
+        if ((a.kr > 0) != (b.kr > 0) || (a.kt > 0) != (b.kt > 0)) return false;
+        if (a.kt > 0 && a.ior != b.ior) return false;
+    }
+
+    return true;
+}
+
+bool relightable(const Scene& before, const Scene& after) {
+    if (!sameCamera(before, after) ||
+        before.pigments.size() != after.pigments.size() ||
+        before.objects.size() != after.objects.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < before.pigments.size(); i++) {
+        if (!samePigment(before.pigments[i], after.pigments[i])) return false;
+    }
+
+    for (size_t i = 0; i < before.objects.size(); i++) {
+        const Object& a = before.objects[i];
+        const Object& b = after.objects[i];
+        if (a.pigmentIdx != b.pigmentIdx || a.finishIdx != b.finishIdx ||
+            !sameGeometry(a, b)) return false;
+    }
+
+    return relightable(before.lights, before.finishes, after.lights, after.finishes);
+}
+
+bool raysMayCross(const AABB* hitBounds, int levels, const AABB& escapeBounds,
+                  const Vec3& eye, Real aperture,
+                  const std::vector<Light>& lights, const AABB& box) {
+    if (escapeBounds.valid() && escapeBounds.overlaps(box)) return true;
+
+    // Folga para as origens deslocadas por SHADOW_BIAS
+    const Vec3 bias(0.01, 0.01, 0.01);
+
+    // Fecho convexo de (caixa ∪ ponto) ⊂ segmento(centro, ponto) ⊕ meia-extensão
+    Vec3 prevCenter = eye;
+    Vec3 prevHalf(aperture, aperture, aperture);
+
+    for (int d = 0; d < levels && hitBounds[d].valid(); d++) {
+        Vec3 half = hitBounds[d].extent() * 0.5 + bias;
+        Vec3 center = hitBounds[d].center();
+
+        // Raios do nível anterior (ou do olho) até os pontos deste nível
+        Vec3 margin(std::max(half.x, prevHalf.x), std::max(half.y, prevHalf.y),
+                    std::max(half.z, prevHalf.z));
+        if (segmentMayCross(prevCenter, center, margin, box)) return true;
+
+        // Raios de sombra
+        for (size_t i = 1; i < lights.size(); i++) {
+            if (segmentMayCross(center, lights[i].position, half, box)) return true;
+        }
+
+        prevCenter = center;
+        prevHalf = half;
+    }
+
+    return false;
+}
@@ -1,16 +1,19 @@
 // src/intersect.cpp
 #include "../include/intersect.hpp"
+#include "../include/bvh.hpp"
+#include "../include/stats.hpp"
+#include <algorithm>
 #include <limits>
 #include <cmath>
 
 namespace Intersect {
 
 // Resolver equação quadrática: at² + bt + c = 0
-bool solveQuadratic(double a, double b, double c, double& t1, double& t2) {
-    double discriminant = b*b - 4*a*c;
+bool solveQuadratic(Real a, Real b, Real c, Real& t1, Real& t2) {
+    Real discriminant = b*b - 4*a*c;
     if (discriminant < 0) return false;
     
-    double sqrtd = std::sqrt(discriminant);
+    Real sqrtd = std::sqrt(discriminant);
     t1 = (-b - sqrtd) / (2*a);
     t2 = (-b + sqrtd) / (2*a);
     return true;
@@ -26,17 +29,17 @@ void adjustNormal(Vec3& normal, const Vec3& rayDir) {
 // Interseção com esfera
 bool sphere(const Ray& ray, const Object& obj, HitInfo& hit) {
     const Vec3& center = obj.sphere.center;
-    double radius = obj.sphere.radius;
+    Real radius = obj.sphere.radius;
     
     Vec3 oc = ray.origin - center;
-    double a = ray.direction.dot(ray.direction);
-    double b = 2.0 * oc.dot(ray.direction);
-    double c = oc.dot(oc) - radius * radius;
+    Real a = ray.direction.dot(ray.direction);
+    Real b = 2 * oc.dot(ray.direction);
+    Real c = oc.dot(oc) - radius * radius;
     
-    double t1, t2;
+    Real t1, t2;
     if (!solveQuadratic(a, b, c, t1, t2)) return false;
     
-    double t = (t1 > EPSILON) ? t1 : t2;
+    Real t = (t1 > EPSILON) ? t1 : t2;
     if (t < EPSILON) return false;
     
     hit.hit = true;
@@ -48,67 +51,99 @@ bool sphere(const Ray& ray, const Object& obj, HitInfo& hit) {
     return true;
 }
 
-// Interseção com poliedro convexo
+// Interseção com poliedro convexo: slabs sobre os planos em SoA, em blocos de
+// PLANE_LANES raias sem desvios (vetorizado pelo compilador). Cada raia guarda
+// a maior entrada e a menor saída com suas faces; a redução final dá as duas
+// faces, então a normal de saída (raio partindo de dentro) sai da mesma passada.
 bool polyhedron(const Ray& ray, const Object& obj, HitInfo& hit) {
-    double tNear = -std::numeric_limits<double>::max();
-    double tFar = std::numeric_limits<double>::max();
-    Vec3 nearNormal;
-    bool foundNear = false;
-    
-    for (const auto& plane : obj.faces) {
-        Vec3 n = plane.normal();
-        double denom = n.dot(ray.direction);
-        double num = -(n.dot(ray.origin) + plane.d);
-        
-        if (std::fabs(denom) < EPSILON) {
-            if (num < 0) return false;
-            continue;
+    constexpr size_t L = PLANE_LANES;
+    constexpr Real INF = std::numeric_limits<Real>::max();
+    
+    const PlaneSoA& planes = obj.faceSoA;
+    const size_t count = planes.size();
+    const Real* __restrict pa = planes.a.data();
+    const Real* __restrict pb = planes.b.data();
+    const Real* __restrict pc = planes.c.data();
+    const Real* __restrict pd = planes.d.data();
+    
+    const Real ox = ray.origin.x, oy = ray.origin.y, oz = ray.origin.z;
+    const Real dx = ray.direction.x, dy = ray.direction.y, dz = ray.direction.z;
+    
+    // Índices de face em Real: todas as raias com o mesmo tipo vetorizam juntas
+    Real tNear[L], tFar[L], nearFace[L], farFace[L], outside[L];
+    for (size_t l = 0; l < L; l++) {
+        tNear[l] = -INF;
+        tFar[l] = INF;
+        nearFace[l] = -1;
+        farFace[l] = -1;
+        outside[l] = 0;
+    }
+    
+    for (size_t base = 0; base < count; base += L) {
+        for (size_t l = 0; l < L; l++) {
+            const size_t i = base + l;
+            Real denom = pa[i]*dx + pb[i]*dy + pc[i]*dz;
+            Real num = -(pa[i]*ox + pb[i]*oy + pc[i]*oz + pd[i]);
+            Real t = num / denom;  // Sem uso quando o raio é paralelo ao plano
+            
+            // Só selects e max/min (sem desvios): o bloco vira instruções vetoriais
+            Real tEnter = denom <= -EPSILON ? t : -INF;
+            Real tExit = denom >= EPSILON ? t : INF;
+            
+            // Paralelo ao plano e do lado de fora: nunca entra
+            Real out = (denom > -EPSILON && denom < EPSILON && num < 0) ? Real(1) : Real(0);
+            outside[l] = std::max(outside[l], out);
+            
+            Real face = static_cast<Real>(i);
+            nearFace[l] = tEnter > tNear[l] ? face : nearFace[l];
+            tNear[l] = tEnter > tNear[l] ? tEnter : tNear[l];
+            farFace[l] = tExit < tFar[l] ? face : farFace[l];
+            tFar[l] = tExit < tFar[l] ? tExit : tFar[l];
         }
         
-        double t = num / denom;
-        
-        if (denom < 0) {
-            // Entrando
-            if (t > tNear) {
-                tNear = t;
-                nearNormal = n;
-                foundNear = true;
-            }
-        } else {
-            // Saindo
-            if (t < tFar) {
-                tFar = t;
-            }
+        // Saída antecipada por bloco: intervalo já vazio (raio passa ao lado)
+        Real blockNear = tNear[0], blockFar = tFar[0], blockOut = outside[0];
+        for (size_t l = 1; l < L; l++) {
+            blockNear = std::max(blockNear, tNear[l]);
+            blockFar = std::min(blockFar, tFar[l]);
+            blockOut = std::max(blockOut, outside[l]);
         }
-        
-        if (tNear > tFar) return false;
+        if (blockNear > blockFar || blockOut != 0) return false;
     }
     
-    // Se tNear é negativo, usar tFar (estamos dentro)
-    if (tNear < EPSILON) {
-        tNear = tFar;
-        // Encontrar normal da face de saída
-        for (const auto& plane : obj.faces) {
-            Vec3 n = plane.normal();
-            double denom = n.dot(ray.direction);
-            if (denom > EPSILON) {
-                double num = -(n.dot(ray.origin) + plane.d);
-                double t = num / denom;
-                if (std::fabs(t - tNear) < EPSILON) {
-                    nearNormal = -n;
-                    foundNear = true;
-                    break;
-                }
-            }
+    // Redução entre raias (empates ficam com a face de menor índice)
+    Real tIn = -INF, tOut = INF, inFace = -1, outFace = -1;
+    for (size_t l = 0; l < L; l++) {
+        if (outside[l] != 0) return false;
+        if (tNear[l] > tIn || (tNear[l] == tIn && nearFace[l] < inFace)) {
+            tIn = tNear[l];
+            inFace = nearFace[l];
+        }
+        if (tFar[l] < tOut || (tFar[l] == tOut && farFace[l] < outFace)) {
+            tOut = tFar[l];
+            outFace = farFace[l];
         }
     }
     
-    if (tNear < EPSILON || !foundNear) return false;
+    if (tIn > tOut) return false;
     
+    // Origem dentro (tIn negativo): o impacto é a saída, com a normal invertida
+    Real t = tIn;
+    Real face = inFace;
+    Real side = 1;
+    if (tIn < EPSILON) {
+        t = tOut;
+        face = outFace;
+        side = -1;
+    }
+    
+    if (t < EPSILON || face < 0) return false;
+    
+    const size_t f = static_cast<size_t>(face);
     hit.hit = true;
-    hit.t = tNear;
-    hit.point = ray.at(tNear);
-    hit.normal = nearNormal.normalize();
+    hit.t = t;
+    hit.point = ray.at(t);
+    hit.normal = (Vec3(pa[f], pb[f], pc[f]) * side).normalize();
     adjustNormal(hit.normal, ray.direction);
     
     return true;
@@ -123,22 +158,22 @@ bool triangle(const Ray& ray, const Object& obj, HitInfo& hit) {
     Vec3 e1 = v1 - v0;
     Vec3 e2 = v2 - v0;
     Vec3 h = ray.direction.cross(e2);
-    double a = e1.dot(h);
+    Real a = e1.dot(h);
     
     if (std::fabs(a) < EPSILON) return false;
     
-    double f = 1.0 / a;
+    Real f = 1 / a;
     Vec3 s = ray.origin - v0;
-    double u = f * s.dot(h);
+    Real u = f * s.dot(h);
     
-    if (u < 0.0 || u > 1.0) return false;
+    if (u < 0 || u > 1) return false;
     
     Vec3 q = s.cross(e1);
-    double v = f * ray.direction.dot(q);
+    Real v = f * ray.direction.dot(q);
     
-    if (v < 0.0 || u + v > 1.0) return false;
+    if (v < 0 || u + v > 1) return false;
     
-    double t = f * e2.dot(q);
+    Real t = f * e2.dot(q);
     if (t < EPSILON) return false;
     
     hit.hit = true;
@@ -152,12 +187,12 @@ bool triangle(const Ray& ray, const Object& obj, HitInfo& hit) {
 
 // Função auxiliar para cilindro e cone
 template<typename CheckFunc>
-bool intersectCylindrical(const Ray& ray, double a_coef, double b_coef, double c_coef,
+bool intersectCylindrical(const Ray& ray, Real a_coef, Real b_coef, Real c_coef,
                           CheckFunc checkHeight, HitInfo& hit) {
-    double t1, t2;
+    Real t1, t2;
     if (!solveQuadratic(a_coef, b_coef, c_coef, t1, t2)) return false;
     
-    double t = -1;
+    Real t = -1;
     if (checkHeight(t1)) t = t1;
     else if (checkHeight(t2)) t = t2;
     
@@ -173,21 +208,21 @@ bool intersectCylindrical(const Ray& ray, double a_coef, double b_coef, double c
 bool cylinder(const Ray& ray, const Object& obj, HitInfo& hit) {
     const Vec3& base = obj.cylinderCone.base;
     Vec3 axis = obj.cylinderCone.axis.normalize();
-    double radius = obj.cylinderCone.radius1;
-    double height = obj.cylinderCone.height;
+    Real radius = obj.cylinderCone.radius1;
+    Real height = obj.cylinderCone.height;
     
     Vec3 oc = ray.origin - base;
-    double axis_dot_dir = ray.direction.dot(axis);
-    double axis_dot_oc = oc.dot(axis);
+    Real axis_dot_dir = ray.direction.dot(axis);
+    Real axis_dot_oc = oc.dot(axis);
     
-    double a = ray.direction.dot(ray.direction) - axis_dot_dir * axis_dot_dir;
-    double b = 2.0 * (ray.direction.dot(oc) - axis_dot_dir * axis_dot_oc);
-    double c = oc.dot(oc) - axis_dot_oc * axis_dot_oc - radius * radius;
+    Real a = ray.direction.dot(ray.direction) - axis_dot_dir * axis_dot_dir;
+    Real b = 2 * (ray.direction.dot(oc) - axis_dot_dir * axis_dot_oc);
+    Real c = oc.dot(oc) - axis_dot_oc * axis_dot_oc - radius * radius;
     
-    auto checkHeight = [&](double t) -> bool {
+    auto checkHeight = [&](Real t) -> bool {
         if (t < EPSILON) return false;
         Vec3 p = ray.at(t);
-        double h = (p - base).dot(axis);
+        Real h = (p - base).dot(axis);
         return (h >= 0 && h <= height);
     };
     
@@ -195,7 +230,7 @@ bool cylinder(const Ray& ray, const Object& obj, HitInfo& hit) {
         return false;
     
     Vec3 op = hit.point - base;
-    double proj = op.dot(axis);
+    Real proj = op.dot(axis);
     hit.normal = (op - axis * proj).normalize();
     adjustNormal(hit.normal, ray.direction);
     
@@ -206,23 +241,23 @@ bool cylinder(const Ray& ray, const Object& obj, HitInfo& hit) {
 bool cone(const Ray& ray, const Object& obj, HitInfo& hit) {
     const Vec3& apex = obj.cylinderCone.base;
     Vec3 axis = obj.cylinderCone.axis.normalize();
-    double height = obj.cylinderCone.height;
-    double radius = obj.cylinderCone.radius1;
-    double k = radius / height;
-    double k2 = 1 + k*k;
+    Real height = obj.cylinderCone.height;
+    Real radius = obj.cylinderCone.radius1;
+    Real k = radius / height;
+    Real k2 = 1 + k*k;
     
     Vec3 oc = ray.origin - apex;
-    double axis_dot_dir = ray.direction.dot(axis);
-    double axis_dot_oc = oc.dot(axis);
+    Real axis_dot_dir = ray.direction.dot(axis);
+    Real axis_dot_oc = oc.dot(axis);
     
-    double a = ray.direction.dot(ray.direction) - k2 * axis_dot_dir * axis_dot_dir;
-    double b = 2.0 * (ray.direction.dot(oc) - k2 * axis_dot_dir * axis_dot_oc);
-    double c = oc.dot(oc) - k2 * axis_dot_oc * axis_dot_oc;
+    Real a = ray.direction.dot(ray.direction) - k2 * axis_dot_dir * axis_dot_dir;
+    Real b = 2 * (ray.direction.dot(oc) - k2 * axis_dot_dir * axis_dot_oc);
+    Real c = oc.dot(oc) - k2 * axis_dot_oc * axis_dot_oc;
     
-    auto checkHeight = [&](double t) -> bool {
+    auto checkHeight = [&](Real t) -> bool {
         if (t < EPSILON) return false;
         Vec3 p = ray.at(t);
-        double h = (p - apex).dot(axis);
+        Real h = (p - apex).dot(axis);
         return (h >= 0 && h <= height);
     };
     
@@ -230,7 +265,7 @@ bool cone(const Ray& ray, const Object& obj, HitInfo& hit) {
         return false;
     
     Vec3 op = hit.point - apex;
-    double h = op.dot(axis);
+    Real h = op.dot(axis);
     Vec3 proj = axis * h;
     hit.normal = (op - proj * k2).normalize();
     adjustNormal(hit.normal, ray.direction);
@@ -238,39 +273,120 @@ bool cone(const Ray& ray, const Object& obj, HitInfo& hit) {
     return true;
 }
 
-// Interseção com quádrica
-bool quadric(const Ray& ray, const Object& obj, HitInfo& hit) {
-    const auto& q = obj.quadric;
+// Escolher a raiz e aplicar o volume de corte; t1 <= t2
+static bool quadricRoot(const Ray& ray, const QuadricData& q, Real t1, Real t2, HitInfo& hit) {
+    Real t = (t1 > EPSILON) ? t1 : t2;
+    if (t < EPSILON) return false;
+    
+    // Quádrica cortada: a raiz mais próxima pode cair fora do volume
+    Vec3 point = ray.at(t);
+    if (q.clipped() && !q.insideClip(point)) {
+        if (t == t2 || t2 < EPSILON) return false;
+        t = t2;
+        point = ray.at(t);
+        if (!q.insideClip(point)) return false;
+    }
+    
+    hit.hit = true;
+    hit.t = t;
+    hit.point = point;
+    return true;
+}
+
+// Núcleo geral: os dez coeficientes
+static bool quadricGeneral(const Ray& ray, const QuadricData& q, HitInfo& hit) {
     const Vec3& o = ray.origin;
     const Vec3& d = ray.direction;
     
-    double Aq = q.A*d.x*d.x + q.B*d.y*d.y + q.C*d.z*d.z +
+    Real Aq = q.A*d.x*d.x + q.B*d.y*d.y + q.C*d.z*d.z +
                 q.D*d.x*d.y + q.E*d.x*d.z + q.F*d.y*d.z;
     
-    double Bq = 2.0*q.A*o.x*d.x + 2.0*q.B*o.y*d.y + 2.0*q.C*o.z*d.z +
+    Real Bq = 2*q.A*o.x*d.x + 2*q.B*o.y*d.y + 2*q.C*o.z*d.z +
                 q.D*(o.x*d.y + o.y*d.x) + q.E*(o.x*d.z + o.z*d.x) +
                 q.F*(o.y*d.z + o.z*d.y) + q.G*d.x + q.H*d.y + q.I*d.z;
     
-    double Cq = q.A*o.x*o.x + q.B*o.y*o.y + q.C*o.z*o.z +
+    Real Cq = q.A*o.x*o.x + q.B*o.y*o.y + q.C*o.z*o.z +
                 q.D*o.x*o.y + q.E*o.x*o.z + q.F*o.y*o.z +
                 q.G*o.x + q.H*o.y + q.I*o.z + q.J;
     
-    double t1, t2;
+    Real t1, t2;
     if (!solveQuadratic(Aq, Bq, Cq, t1, t2)) return false;
     
-    double t = (t1 > EPSILON) ? t1 : t2;
-    if (t < EPSILON) return false;
-    
-    hit.hit = true;
-    hit.t = t;
-    hit.point = ray.at(t);
+    // Raízes em ordem crescente (Aq < 0 as inverte)
+    if (t1 > t2) std::swap(t1, t2);
+    if (!quadricRoot(ray, q, t1, t2, hit)) return false;
     
     const Vec3& p = hit.point;
     hit.normal = Vec3(
-        2.0*q.A*p.x + q.D*p.y + q.E*p.z + q.G,
-        2.0*q.B*p.y + q.D*p.x + q.F*p.z + q.H,
-        2.0*q.C*p.z + q.E*p.x + q.F*p.y + q.I
+        2*q.A*p.x + q.D*p.y + q.E*p.z + q.G,
+        2*q.B*p.y + q.D*p.x + q.F*p.z + q.H,
+        2*q.C*p.z + q.E*p.x + q.F*p.y + q.I
     ).normalize();
+    return true;
+}
+
+// Alinhada aos eixos: diag·(u∘u) + linear·u + constant, u = p - center
+static bool quadricAxis(const Ray& ray, const QuadricData& q, HitInfo& hit) {
+    Vec3 u = ray.origin - q.center;
+    const Vec3& d = ray.direction;
+    Vec3 au = q.diag.mul(u);
+    
+    Real Aq = q.diag.dot(d.mul(d));
+    Real Bq = (au * 2 + q.linear).dot(d);
+    Real Cq = (au + q.linear).dot(u) + q.constant;
+    
+    Real t1, t2;
+    if (!solveQuadratic(Aq, Bq, Cq, t1, t2)) return false;
+    if (t1 > t2) std::swap(t1, t2);
+    if (!quadricRoot(ray, q, t1, t2, hit)) return false;
+    
+    hit.normal = (q.diag.mul(hit.point - q.center) * 2 + q.linear).normalize();
+    return true;
+}
+
+// Elipsoide alinhado: esfera unitária no espaço escalado por diag
+static bool quadricEllipsoid(const Ray& ray, const QuadricData& q, HitInfo& hit) {
+    Vec3 o = q.diag.mul(ray.origin - q.center);
+    Vec3 d = q.diag.mul(ray.direction);
+    
+    // Forma com b/2: a > 0, raízes já em ordem
+    Real a = d.dot(d);
+    Real b = o.dot(d);
+    Real c = o.dot(o) - 1;
+    Real discriminant = b*b - a*c;
+    if (discriminant < 0) return false;
+    
+    Real sqrtd = std::sqrt(discriminant);
+    if (!quadricRoot(ray, q, (-b - sqrtd) / a, (-b + sqrtd) / a, hit)) return false;
+    
+    Vec3 s2 = q.diag.mul(q.diag);
+    hit.normal = s2.mul(hit.point - q.center).normalize();
+    return true;
+}
+
+// Sem termos quadráticos: plano linear·p + constant = 0
+static bool quadricPlane(const Ray& ray, const QuadricData& q, HitInfo& hit) {
+    Real denom = q.linear.dot(ray.direction);
+    if (std::fabs(denom) < EPSILON) return false;
+    
+    Real t = -(q.linear.dot(ray.origin) + q.constant) / denom;
+    if (!quadricRoot(ray, q, t, t, hit)) return false;
+    
+    hit.normal = q.linear.normalize();
+    return true;
+}
+
+// Interseção com quádrica (núcleo escolhido na carga por classifyQuadric)
+bool quadric(const Ray& ray, const Object& obj, HitInfo& hit) {
+    const auto& q = obj.quadric;
+    bool found;
+    switch (q.kernel) {
+        case QKERNEL_ELLIPSOID: found = quadricEllipsoid(ray, q, hit); break;
+        case QKERNEL_AXIS:      found = quadricAxis(ray, q, hit); break;
+        case QKERNEL_PLANE:     found = quadricPlane(ray, q, hit); break;
+        default:                found = quadricGeneral(ray, q, hit); break;
+    }
+    if (!found) return false;
     
     adjustNormal(hit.normal, ray.direction);
     return true;
@@ -278,31 +394,90 @@ bool quadric(const Ray& ray, const Object& obj, HitInfo& hit) {
 
 } // namespace Intersect
 
+// Tabela de funções de interseção
+using IntersectFunc = bool(*)(const Ray&, const Object&, HitInfo&);
+static const IntersectFunc intersectFuncs[] = {
+    Intersect::sphere,      // SPHERE
+    Intersect::polyhedron,  // POLYHEDRON
+    Intersect::quadric,     // QUADRIC
+    Intersect::triangle,    // TRIANGLE
+    Intersect::cylinder,    // CYLINDER
+    Intersect::cone         // CONE
+};
+
+bool intersectObject(const Ray& ray, const Scene& scene, int idx, HitInfo& hit,
+                     RenderStats* stats) {
+    ObjectType type = scene.objects[idx].type;
+    bool found = intersectFuncs[type](ray, scene.objects[idx], hit);
+    
+    if (stats) {
+        stats->tests[type]++;
+        if (found) stats->hits[type]++;
+    }
+    
+    hit.objectIdx = idx;
+    return found;
+}
+
+// Testar um objeto e atualizar a interseção mais próxima
+static inline void testObject(const Ray& ray, const Scene& scene, int idx, HitInfo& closest,
+                              RenderStats* stats) {
+    HitInfo hit;
+    if (intersectObject(ray, scene, idx, hit, stats) && hit.t < closest.t) {
+        closest = hit;
+    }
+}
+
 // Função principal
-HitInfo findClosestHit(const Ray& ray, const Scene& scene) {
+HitInfo findClosestHit(const Ray& ray, const Scene& scene, RenderStats* stats) {
     HitInfo closest;
-    closest.t = std::numeric_limits<double>::max();
-    
-    // Tabela de funções de interseção
-    using IntersectFunc = bool(*)(const Ray&, const Object&, HitInfo&);
-    static const IntersectFunc intersectFuncs[] = {
-        Intersect::sphere,      // SPHERE
-        Intersect::polyhedron,  // POLYHEDRON
-        Intersect::quadric,     // QUADRIC
-        Intersect::triangle,    // TRIANGLE
-        Intersect::cylinder,    // CYLINDER
-        Intersect::cone         // CONE
-    };
+    closest.t = std::numeric_limits<Real>::max();
+    
+    // Sem BVH: teste exaustivo
+    if (scene.bvh.empty()) {
+        for (size_t i = 0; i < scene.objects.size(); i++) {
+            testObject(ray, scene, static_cast<int>(i), closest, stats);
+        }
+        return closest;
+    }
+    
+    // Objetos ilimitados são sempre testados
+    for (int idx : scene.bvh.unbounded) {
+        testObject(ray, scene, idx, closest, stats);
+    }
+    
+    Vec3 invDir(1 / ray.direction.x, 1 / ray.direction.y, 1 / ray.direction.z);
     
-    for (size_t i = 0; i < scene.objects.size(); i++) {
-        const Object& obj = scene.objects[i];
-        HitInfo hit;
+    int stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    
+    while (stackSize > 0) {
+        const BVHNode& node = scene.bvh.nodes[stack[--stackSize]];
+        if (stats) stats->bvhNodes++;
+        if (!intersectAABB(ray, invDir, node.bounds, closest.t)) continue;
         
-        if (intersectFuncs[obj.type](ray, obj, hit) && hit.t < closest.t) {
-            closest = hit;
-            closest.objectIdx = i;
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                testObject(ray, scene, scene.bvh.objectIndices[i], closest, stats);
+            }
+        } else {
+            stack[stackSize++] = node.left;
+            stack[stackSize++] = node.right;
         }
     }
     
+    return closest;
+}
+
+HitInfo findClosestHit(const Ray& ray, const Scene& scene, const std::vector<int>& candidates,
+                       RenderStats* stats) {
+    HitInfo closest;
+    closest.t = std::numeric_limits<Real>::max();
+    
+    for (int idx : candidates) {
+        testObject(ray, scene, idx, closest, stats);
+    }
+    
     return closest;
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+// src/irradiance.cpp
+#include "../include/irradiance.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Limites do raio de validade, em fração da diagonal da cena: cantos não
+// geram registros sem fim e regiões abertas ainda são amostradas
+constexpr Real MIN_RADIUS_FRACTION = 0.002;
+constexpr Real MAX_RADIUS_FRACTION = 0.1;
+
+constexpr int MAX_OCTREE_DEPTH = 24;
+
+// Registro à frente do ponto (o ponto fica atrás da superfície do registro):
+// a irradiância dele não vale para o ponto
+constexpr Real FRONT_TOLERANCE = 0.05;
+
+int childIndex(const Vec3& center, const Vec3& p) {
+    return (p.x > center.x ? 1 : 0) | (p.y > center.y ? 2 : 0) | (p.z > center.z ? 4 : 0);
+}
+
+Vec3 childCenter(const Vec3& center, Real half, int child) {
+    Real q = half * 0.5;
+    return Vec3(center.x + ((child & 1) ? q : -q),
+                center.y + ((child & 2) ? q : -q),
+                center.z + ((child & 4) ? q : -q));
+}
+
+// Ponto a até 'reach' (por eixo) do centro do nó
+bool withinNode(const Vec3& center, Real reach, const Vec3& p) {
+    return std::fabs(p.x - center.x) <= reach && std::fabs(p.y - center.y) <= reach &&
+           std::fabs(p.z - center.z) <= reach;
+}
+
+// Distância ao quadrado do ponto à caixa do nó (zero dentro)
+Real boxDistance2(const Vec3& center, Real half, const Vec3& p) {
+    Real dx = std::max(Real(0), std::fabs(p.x - center.x) - half);
+    Real dy = std::max(Real(0), std::fabs(p.y - center.y) - half);
+    Real dz = std::max(Real(0), std::fabs(p.z - center.z) - half);
+    return dx*dx + dy*dy + dz*dz;
+}
+
+} // namespace anônimo
+
+void IrradianceCache::reset(const AABB& bounds, const IrradianceParams& p, uint64_t s) {
+    params = p;
+    seed = s;
+    recordCount = 0;
+    nodes.clear();
+
+    Node root;
+    Real diagonal = 1;
+    if (bounds.valid()) {
+        root.center = bounds.center();
+        Vec3 e = bounds.extent();
+        root.half = std::max({e.x, e.y, e.z}) * Real(0.5) * Real(1.01) + EPSILON;
+        diagonal = std::max(e.length(), EPSILON);
+    } else {
+        root.half = 1;
+    }
+    nodes.push_back(root);
+
+    minRadius = diagonal * MIN_RADIUS_FRACTION;
+    maxRadius = diagonal * MAX_RADIUS_FRACTION;
+}
+
+void IrradianceCache::insert(IrradianceRecord record) {
+    record.radius = std::clamp(record.radius, minRadius, maxRadius);
+    const Real reach = params.maxError * record.radius;
+    recordCount++;
+
+    // Descer enquanto o filho ainda cobre o alcance; pontos fora da raiz ficam nela
+    int node = 0;
+    for (int depth = 0; depth < MAX_OCTREE_DEPTH; depth++) {
+        Node& n = nodes[node];
+        n.reach = std::max(n.reach, reach);
+        if (n.half * Real(0.5) < reach || !withinNode(n.center, n.half, record.point)) break;
+
+        int c = childIndex(n.center, record.point);
+        if (n.children[c] < 0) {
+            Node child;
+            child.center = childCenter(n.center, n.half, c);
+            child.half = n.half * Real(0.5);
+            n.children[c] = static_cast<int>(nodes.size());
+            nodes.push_back(child);   // Invalida 'n'
+        }
+        node = nodes[node].children[c];
+    }
+    nodes[node].records.push_back(record);
+}
+
+bool IrradianceCache::lookup(const Vec3& point, const Vec3& normal, Vec3& value,
+                             Real relax) const {
+    if (nodes.empty()) return false;
+
+    const Real maxError = params.maxError * relax;
+    const Real invError = 1 / maxError;
+    Real weightSum = 0;
+    Vec3 sum(0, 0, 0);
+
+    int stack[8 * MAX_OCTREE_DEPTH + 1];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const Node& n = nodes[stack[--top]];
+
+        for (const IrradianceRecord& r : n.records) {
+            Vec3 offset = point - r.point;
+            
+            // Fora do alcance mesmo com normais iguais: descarte sem raízes
+            Real reach = maxError * r.radius;
+            Real distance2 = offset.lengthSquared();
+            if (distance2 >= reach * reach) continue;
+            if (offset.dot(normal + r.normal) * Real(0.5) < -FRONT_TOLERANCE * r.radius) continue;
+
+            // Erro estimado de Ward: distância relativa + desvio da normal
+            Real error = std::sqrt(distance2) / r.radius +
+                         std::sqrt(std::max(Real(0), 1 - normal.dot(r.normal)));
+            if (error >= maxError) continue;
+
+            // Peso que cai a zero na borda de validade: interpolação sem degraus
+            Real w = 1 / std::max(error, EPSILON) - invError;
+            sum = sum + r.value * w;
+            weightSum += w;
+        }
+
+        for (int c = 0; c < 8; c++) {
+            int child = n.children[c];
+            // Registros da subárvore estão dentro da caixa do filho
+            if (child < 0) continue;
+            const Node& c2 = nodes[child];
+            Real reach = c2.reach * relax;
+            if (boxDistance2(c2.center, c2.half, point) < reach * reach) {
+                stack[top++] = child;
+            }
+        }
+    }
+
+    if (weightSum <= 0) return false;
+    value = sum / weightSum;
+    return true;
+}
@@ -1,5 +1,8 @@
 // src/loader.cpp
 #include "../include/loader.hpp"
+#include "../include/threadpool.hpp"
+#include "../include/trace.hpp"
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -48,12 +51,14 @@ bool loadPPM(const std::string& filename, Pigment& pigment) {
             pixel = Vec3(r, g, b) / maxval;
         }
     } else {
-        // Binário
+        // Binário: uma única leitura e conversão em memória
         file.get(); // Pular newline
+        std::vector<unsigned char> rgb(pigment.textureData.size() * 3);
+        file.read(reinterpret_cast<char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+        const unsigned char* src = rgb.data();
         for (auto& pixel : pigment.textureData) {
-            unsigned char rgb[3];
-            file.read(reinterpret_cast<char*>(rgb), 3);
-            pixel = Vec3(rgb[0], rgb[1], rgb[2]) / maxval;
+            pixel = Vec3(src[0], src[1], src[2]) / maxval;
+            src += 3;
         }
     }
     
@@ -97,7 +102,7 @@ static bool loadPigment(std::ifstream& file, Pigment& pigment) {
         for (int i = 0; i < 4; i++) {
             if (!readData(file, pigment.p1[i])) return false;
         }
-        return loadPPM(pigment.texturePath, pigment);
+        return true;    // Textura decodificada depois, no pool (loadScene)
     }
     
     return false;
@@ -114,6 +119,44 @@ static bool loadFinish(std::ifstream& file, Finish& finish) {
            readData(file, finish.ior);
 }
 
+// Volumes de corte opcionais após os coeficientes da quádrica, em qualquer
+// ordem: "clip x0 y0 z0 x1 y1 z1" (caixa) e "planes n a b c d ..." (semi-espaços)
+static bool loadQuadricClip(std::ifstream& file, QuadricData& q) {
+    while (true) {
+        std::streampos pos = file.tellg();
+        std::string word;
+        if (!(file >> word)) {
+            file.clear();
+            file.seekg(pos);
+            return true;
+        }
+        
+        if (word == "clip") {
+            Vec3 a, b;
+            if (!(readData(file, a.x) && readData(file, a.y) && readData(file, a.z) &&
+                  readData(file, b.x) && readData(file, b.y) && readData(file, b.z))) return false;
+            q.clipBox = AABB();
+            q.clipBox.expand(a);
+            q.clipBox.expand(b);
+        }
+        else if (word == "planes") {
+            int numPlanes;
+            if (!(file >> numPlanes) || numPlanes < 0) return false;
+            for (int i = 0; i < numPlanes; i++) {
+                Real a, b, c, d;
+                if (!(readData(file, a) && readData(file, b) &&
+                      readData(file, c) && readData(file, d))) return false;
+                q.clipPlanes.emplace_back(a, b, c, d);
+            }
+        }
+        else {
+            // Início do próximo objeto
+            file.seekg(pos);
+            return true;
+        }
+    }
+}
+
 // Carregar objeto
 static bool loadObject(std::ifstream& file, Object& obj) {
     int pigmentIdx, finishIdx;
@@ -144,6 +187,7 @@ static bool loadObject(std::ifstream& file, Object& obj) {
                   readData(file, c) && readData(file, d))) return false;
             obj.faces.emplace_back(a, b, c, d);
         }
+        obj.faceSoA.assign(obj.faces);
         return true;
     }
     else if (type == "triangle") {
@@ -191,14 +235,21 @@ static bool loadObject(std::ifstream& file, Object& obj) {
                readData(file, obj.quadric.G) &&
                readData(file, obj.quadric.H) &&
                readData(file, obj.quadric.I) &&
-               readData(file, obj.quadric.J);
+               readData(file, obj.quadric.J) &&
+               loadQuadricClip(file, obj.quadric);
     }
     
     return false;
 }
 
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
 // Carregar cena completa
-bool loadScene(const std::string& filename, Scene& scene) {
+bool loadScene(const std::string& filename, Scene& scene, LoadTimings* timings) {
+    auto start = std::chrono::steady_clock::now();
+    TraceScope parseScope("carga", "leitura");
     std::ifstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Erro ao abrir cena: " << filename << std::endl;
@@ -235,6 +286,25 @@ bool loadScene(const std::string& filename, Scene& scene) {
         scene.pigments.push_back(pigment);
     }
     
+    // Texturas decodificadas no pool enquanto o resto do arquivo é lido. Os
+    // pigmentos não mudam mais de lugar; 'ok' e 'decodeMs' sobrevivem ao grupo,
+    // que espera as tarefas mesmo num retorno antecipado.
+    std::vector<char> ok(scene.pigments.size(), 1);
+    std::vector<double> decodeMs(scene.pigments.size(), 0.0);
+    TaskGroup textures;
+    int textureCount = 0;
+    for (size_t i = 0; i < scene.pigments.size(); i++) {
+        if (scene.pigments[i].type != TEXMAP) continue;
+        textureCount++;
+        textures.run([&scene, &ok, &decodeMs, i] {
+            TraceScope scope("carga", "textura", "pigmento", static_cast<int>(i));
+            auto begin = std::chrono::steady_clock::now();
+            Pigment& pigment = scene.pigments[i];
+            ok[i] = loadPPM(pigment.texturePath, pigment);
+            decodeMs[i] = elapsedMs(begin);
+        });
+    }
+    
     // 4. Finishes
     int numFinishes;
     if (!(file >> numFinishes)) return false;
@@ -258,5 +328,31 @@ bool loadScene(const std::string& filename, Scene& scene) {
     }
     
     file.close();
+    double parseMs = elapsedMs(start);
+    parseScope.end();
+    
+    auto waitStart = std::chrono::steady_clock::now();
+    {
+        TraceScope scope("carga", "espera das texturas");
+        textures.wait();
+    }
+    double waitMs = elapsedMs(waitStart);
+    for (char loaded : ok) {
+        if (!loaded) return false;
+    }
+    
+    auto prepareStart = std::chrono::steady_clock::now();
+    TraceScope prepareScope("carga", "preparo");
+    classifyQuadrics(scene);
+    scene.features = shadeFeatures(scene);
+    
+    if (timings) {
+        timings->parseMs = parseMs;
+        timings->textureWaitMs = waitMs;
+        timings->textureMs = 0.0;
+        for (double ms : decodeMs) timings->textureMs += ms;
+        timings->textures = textureCount;
+        timings->prepareMs = elapsedMs(prepareStart);
+    }
     return true;
 }
\ No newline at end of file
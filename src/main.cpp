@@ -1,8 +1,21 @@
 // src/main.cpp
 #include "../include/raytracer.hpp"
+#include "../include/animation.hpp"
+#include "../include/server.hpp"
+#include "../include/threadpool.hpp"
+#include "../include/shading.hpp"
+#include "../include/trace.hpp"
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <cstdlib>
 #include <ctime>
+#include <fstream>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <vector>
 
 struct Config {
     std::string inputFile;
@@ -12,31 +25,185 @@ struct Config {
     int samples = 16;
     double aperture = 0.0;
     double focusDist = 10.0;
+    
+    // Lote de câmeras sobre a mesma cena
+    std::string camerasFile;
+    
+    // Sequência de animação
+    std::string animFile;
+    int firstFrame = -1;
+    int lastFrame = -1;
+    
+    // Re-renderização incremental de uma cena editada
+    std::string editedFile;
+    std::string editedOutput;
+    
+    // Reiluminação a partir do G-buffer
+    std::string relightFile;
+    std::string relightOutput;
+    
+    // Saída HDR
+    ToneMap toneMap = TONEMAP_CLAMP;
+    double gamma = 1.0;
+    
+    // Pós-processamento
+    bool denoise = false;
+    
+    // Renderização distribuída: região parcial e semente das amostras
+    bool partial = false;
+    Region region;
+    int tileIndex = -1;
+    int tileCount = 0;
+    uint64_t seed = 0;
+    bool hasSeed = false;
+    
+    // Estatísticas: "text" ou "json" (stdout ou arquivo)
+    std::string statsFormat;
+    std::string statsFile;
+    
+    // Linha do tempo por thread (formato de eventos do Chrome)
+    std::string traceFile;
+    
+    // Aproximações rápidas no sombreamento
+    bool fastMath = false;
+    
+    // Iluminação global difusa com cache de irradiância
+    bool gi = false;
+    IrradianceParams giParams;
+    
+    // Mapa de calor de custo por pixel
+    std::string heatmapFile;
+    HeatMetric heatMetric = HEAT_TESTS;
 };
 
 void printUsage(const char* programName) {
     std::cerr << "Uso: " << programName 
-              << " <cena.in> <saida.ppm> [largura] [altura] [amostras] [abertura] [dist_focal]" 
+              << " <cena.in> <saida.ppm> [largura] [altura] [amostras] [abertura] [dist_focal] [opções]" 
               << std::endl;
+    std::cerr << "Opções:" << std::endl;
+    std::cerr << "  --anim <arquivo.anim>   Renderizar sequência de quadros (saida_NNNN.ppm)" << std::endl;
+    std::cerr << "  --frames <N> <M>        Intervalo de quadros da sequência" << std::endl;
+    std::cerr << "  --cameras <arquivo.cams>  Renderizar várias vistas da cena (saida_NNNN.ppm)" << std::endl;
+    std::cerr << "  --diff <editada.in> <saida2.ppm>" << std::endl;
+    std::cerr << "                          Re-renderizar só os pixels afetados pela edição" << std::endl;
+    std::cerr << "  --tonemap <clamp|reinhard|aces>  Mapeamento de tons na saída (padrão: clamp)" << std::endl;
+    std::cerr << "  --gamma <g>             Correção de gama na saída (padrão: 1.0)" << std::endl;
+    std::cerr << "  --denoise               Filtro à-trous guiado por albedo/normal/profundidade" << std::endl;
+    std::cerr << "  --relight <editada.in> <saida2.ppm>" << std::endl;
+    std::cerr << "                          Reiluminar pelo G-buffer (luzes e acabamentos editados)" << std::endl;
+    std::cerr << "  --region <x0> <y0> <x1> <y1>  Renderizar só a região; saída é uma parcial" << std::endl;
+    std::cerr << "  --tile <k>/<N>          Renderizar a faixa k de N; saída é uma parcial" << std::endl;
+    std::cerr << "  --seed <s>              Semente das amostras (padrão: relógio)" << std::endl;
+    std::cerr << "  --stats <text|json>     Contadores de raios/interseções e tempo por fase" << std::endl;
+    std::cerr << "  --stats-out <arquivo>   Gravar as estatísticas em arquivo" << std::endl;
+    std::cerr << "  --trace <arquivo.json>  Linha do tempo por thread (chrome://tracing, Perfetto)" << std::endl;
+    std::cerr << "  --heatmap <arquivo.ppm> [tests|rays|time]  Mapa de calor do custo por pixel" << std::endl;
+    std::cerr << "  --fast-math             Sombreamento aproximado (erro <= 1/255 por canal)" << std::endl;
+    std::cerr << "  --gi                    Luz indireta difusa (cache de irradiância)" << std::endl;
+    std::cerr << "  --gi-rays <N>           Raios por amostra do hemisfério (padrão: 64)" << std::endl;
+    std::cerr << "  --gi-error <a>          Erro tolerado na reutilização (padrão: 0.3)" << std::endl;
+    std::cerr << "Juntar parciais: " << programName
+              << " --merge <saida.ppm> <parcial>... [--tonemap t] [--gamma g]" << std::endl;
+    std::cerr << "Servidor: " << programName
+              << " --server [socket]  (sem socket: protocolo em stdin/stdout)" << std::endl;
     std::cerr << "Exemplo: " << programName 
               << " testes/test5.in resultados/output.ppm" << std::endl;
     std::cerr << "Padrão: 800x600, 16 amostras, sem DOF" << std::endl;
+    std::cerr << "Saída .png ou .qoi: imagem comprimida, codificada durante a renderização"
+              << std::endl;
 }
 
 bool parseArgs(int argc, char** argv, Config& config) {
-    if (argc < 3) {
+    std::vector<std::string> positional;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        
+        if (arg == "--anim" && i + 1 < argc) {
+            config.animFile = argv[++i];
+        } else if (arg == "--cameras" && i + 1 < argc) {
+            config.camerasFile = argv[++i];
+        } else if (arg == "--frames" && i + 2 < argc) {
+            config.firstFrame = std::atoi(argv[++i]);
+            config.lastFrame = std::atoi(argv[++i]);
+        } else if (arg == "--diff" && i + 2 < argc) {
+            config.editedFile = argv[++i];
+            config.editedOutput = argv[++i];
+        } else if (arg == "--relight" && i + 2 < argc) {
+            config.relightFile = argv[++i];
+            config.relightOutput = argv[++i];
+        } else if (arg == "--tonemap" && i + 1 < argc) {
+            if (!parseToneMap(argv[++i], config.toneMap)) {
+                std::cerr << "Mapeamento de tons inválido: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--gamma" && i + 1 < argc) {
+            config.gamma = std::atof(argv[++i]);
+        } else if (arg == "--denoise") {
+            config.denoise = true;
+        } else if (arg == "--region" && i + 4 < argc) {
+            config.partial = true;
+            config.region.x0 = std::atoi(argv[++i]);
+            config.region.y0 = std::atoi(argv[++i]);
+            config.region.x1 = std::atoi(argv[++i]);
+            config.region.y1 = std::atoi(argv[++i]);
+        } else if (arg == "--tile" && i + 1 < argc) {
+            config.partial = true;
+            if (std::sscanf(argv[++i], "%d/%d", &config.tileIndex, &config.tileCount) != 2 ||
+                config.tileCount <= 0 || config.tileIndex < 0 ||
+                config.tileIndex >= config.tileCount) {
+                std::cerr << "Tile inválido (use k/N com 0 <= k < N): " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--stats" && i + 1 < argc) {
+            config.statsFormat = argv[++i];
+            if (config.statsFormat != "text" && config.statsFormat != "json") {
+                std::cerr << "Formato de estatísticas inválido: " << config.statsFormat << std::endl;
+                return false;
+            }
+        } else if (arg == "--heatmap" && i + 1 < argc) {
+            config.heatmapFile = argv[++i];
+            if (i + 1 < argc && parseHeatMetric(argv[i + 1], config.heatMetric)) i++;
+        } else if (arg == "--stats-out" && i + 1 < argc) {
+            config.statsFile = argv[++i];
+            if (config.statsFormat.empty()) config.statsFormat = "json";
+        } else if (arg == "--trace" && i + 1 < argc) {
+            config.traceFile = argv[++i];
+        } else if (arg == "--fast-math") {
+            config.fastMath = true;
+        } else if (arg == "--gi") {
+            config.gi = true;
+        } else if (arg == "--gi-rays" && i + 1 < argc) {
+            config.gi = true;
+            config.giParams.rays = std::atoi(argv[++i]);
+        } else if (arg == "--gi-error" && i + 1 < argc) {
+            config.gi = true;
+            config.giParams.maxError = std::atof(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+            config.hasSeed = true;
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Opção inválida: " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    
+    if (positional.size() < 2) {
         printUsage(argv[0]);
         return false;
     }
     
-    config.inputFile = argv[1];
-    config.outputFile = argv[2];
+    config.inputFile = positional[0];
+    config.outputFile = positional[1];
     
-    if (argc >= 4) config.width = std::atoi(argv[3]);
-    if (argc >= 5) config.height = std::atoi(argv[4]);
-    if (argc >= 6) config.samples = std::atoi(argv[5]);
-    if (argc >= 7) config.aperture = std::atof(argv[6]);
-    if (argc >= 8) config.focusDist = std::atof(argv[7]);
+    if (positional.size() >= 3) config.width = std::atoi(positional[2].c_str());
+    if (positional.size() >= 4) config.height = std::atoi(positional[3].c_str());
+    if (positional.size() >= 5) config.samples = std::atoi(positional[4].c_str());
+    if (positional.size() >= 6) config.aperture = std::atof(positional[5].c_str());
+    if (positional.size() >= 7) config.focusDist = std::atof(positional[6].c_str());
     
     // Validação
     if (config.width <= 0) config.width = 800;
@@ -44,54 +211,358 @@ bool parseArgs(int argc, char** argv, Config& config) {
     if (config.samples <= 0) config.samples = 1;
     if (config.aperture < 0) config.aperture = 0.0;
     if (config.focusDist <= 0) config.focusDist = 10.0;
+    if (config.gamma <= 0) config.gamma = 1.0;
+    if (config.giParams.rays <= 0) config.giParams.rays = IrradianceParams().rays;
+    if (config.giParams.maxError <= 0) config.giParams.maxError = IrradianceParams().maxError;
+    
+    if (config.tileCount > 0) {
+        config.region = tileRegion(config.tileIndex, config.tileCount, config.width, config.height);
+    }
+    if (config.partial && (!config.animFile.empty() || !config.editedFile.empty() ||
+                           !config.relightFile.empty() || config.denoise)) {
+        std::cerr << "--region/--tile não combinam com --anim, --diff, --relight ou --denoise"
+                  << std::endl;
+        return false;
+    }
+    if (config.gi && (!config.relightFile.empty() || !config.camerasFile.empty())) {
+        std::cerr << "--gi não combina com --relight ou --cameras" << std::endl;
+        return false;
+    }
+    if (!config.camerasFile.empty() && (config.partial || !config.animFile.empty() ||
+                                        !config.editedFile.empty() || !config.relightFile.empty() ||
+                                        config.denoise || !config.heatmapFile.empty())) {
+        std::cerr << "--cameras não combina com --region, --tile, --anim, --diff, --relight, "
+                  << "--denoise ou --heatmap" << std::endl;
+        return false;
+    }
     
     return true;
 }
 
+// Modo --merge: somar parciais (regiões distintas ou a mesma região com
+// sementes diferentes) e salvar a imagem final
+int mergeMain(int argc, char** argv) {
+    std::string outputFile;
+    std::vector<std::string> inputs;
+    ToneMap op = TONEMAP_CLAMP;
+    double gamma = 1.0;
+    
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--tonemap" && i + 1 < argc) {
+            if (!parseToneMap(argv[++i], op)) {
+                std::cerr << "Mapeamento de tons inválido: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--gamma" && i + 1 < argc) {
+            gamma = std::atof(argv[++i]);
+            if (gamma <= 0) gamma = 1.0;
+        } else if (outputFile.empty()) {
+            outputFile = arg;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    
+    if (outputFile.empty() || inputs.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    std::vector<PartialImage> parts(inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (!loadPartial(inputs[i], parts[i])) return 1;
+    }
+    
+    // Mesma semente sobre a mesma área repete as mesmas amostras
+    for (size_t i = 0; i < parts.size(); i++) {
+        for (size_t j = 0; j < i; j++) {
+            if (parts[i].seed == parts[j].seed && parts[i].region.overlaps(parts[j].region)) {
+                std::cerr << "Aviso: " << inputs[j] << " e " << inputs[i]
+                          << " se sobrepõem com a mesma semente (amostras repetidas)" << std::endl;
+            }
+        }
+    }
+    
+    RayTracer tracer(parts[0].width, parts[0].height);
+    tracer.setToneMap(op, gamma);
+    for (size_t i = 0; i < parts.size(); i++) {
+        if (!tracer.mergePartial(parts[i])) {
+            std::cerr << "Erro ao juntar parcial: " << inputs[i] << std::endl;
+            return 1;
+        }
+    }
+    
+    const std::vector<uint32_t>& counts = tracer.getSampleCounts();
+    size_t missing = std::count(counts.begin(), counts.end(), 0u);
+    if (missing > 0) {
+        std::cerr << "Aviso: " << missing << " pixels sem amostras" << std::endl;
+    }
+    
+    std::cout << "Salvando imagem: " << outputFile << std::endl;
+    if (!tracer.saveImage(outputFile)) {
+        std::cerr << "Erro ao salvar imagem" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
+
+// Linha do tempo de --trace, gravada com o pool já ocioso
+bool saveTrace(const Config& config) {
+    if (config.traceFile.empty()) return true;
+    std::cout << "Salvando linha do tempo: " << config.traceFile << std::endl;
+    return writeTrace(config.traceFile);
+}
+
+// Relatório de --stats; o tempo de gravação é medido fora do RayTracer
+bool reportStats(const Config& config, const RayTracer& tracer, double saveMs) {
+    if (config.statsFormat.empty()) return true;
+    
+    PhaseTimings timings = tracer.getTimings();
+    timings.saveMs = saveMs;
+    
+    std::ofstream file;
+    if (!config.statsFile.empty()) {
+        file.open(config.statsFile);
+        if (!file.is_open()) {
+            std::cerr << "Erro ao criar arquivo: " << config.statsFile << std::endl;
+            return false;
+        }
+    }
+    std::ostream& out = config.statsFile.empty() ? std::cout : file;
+    
+    if (config.statsFormat == "json") {
+        writeStatsJSON(out, tracer.getStats(), timings, tracer.getScene(), config.width,
+                       config.height, config.samples, ThreadPool::global().size() + 1);
+    } else {
+        printStats(out, tracer.getStats(), timings, tracer.getScene());
+    }
+    return true;
+}
+
 void printConfig(const Config& config) {
     std::cout << "=== Ray Tracer RT-1 ===" << std::endl;
     std::cout << "Cena: " << config.inputFile << std::endl;
     std::cout << "Saída: " << config.outputFile << std::endl;
     std::cout << "Resolução: " << config.width << "x" << config.height << std::endl;
     std::cout << "Amostras por pixel: " << config.samples << std::endl;
+    if (!config.animFile.empty()) {
+        std::cout << "Animação: " << config.animFile << std::endl;
+    }
     if (config.aperture > 0) {
         std::cout << "Depth of Field: abertura=" << config.aperture 
                   << ", foco=" << config.focusDist << std::endl;
     }
+    if (config.partial) {
+        std::cout << "Região: " << config.region.x0 << " " << config.region.y0 << " "
+                  << config.region.x1 << " " << config.region.y1 << std::endl;
+    }
+    std::cout << "Semente: " << config.seed << std::endl;
     std::cout << "=======================" << std::endl;
 }
 
 int main(int argc, char** argv) {
-    std::srand(static_cast<unsigned>(std::time(nullptr)));
+    if (argc >= 2 && std::string(argv[1]) == "--merge") {
+        return mergeMain(argc, argv);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--server") {
+        return argc >= 3 ? runSocketServer(argv[2]) : runStdioServer();
+    }
     
     Config config;
     if (!parseArgs(argc, argv, config)) {
         return 1;
     }
+    if (!config.hasSeed) config.seed = static_cast<uint64_t>(std::time(nullptr));
     
     printConfig(config);
+    if (!config.traceFile.empty()) traceEnable();
     
     // Criar e configurar ray tracer
     RayTracer tracer(config.width, config.height, config.samples);
     tracer.setDOF(config.aperture, config.focusDist);
+    tracer.setToneMap(config.toneMap, config.gamma);
+    tracer.setSeed(config.seed);
+    tracer.setStats(!config.statsFormat.empty());
+    tracer.setHeatmap(!config.heatmapFile.empty(), config.heatMetric);
+    tracer.setFastMath(config.fastMath);
+    tracer.setGlobalIllumination(config.gi, config.giParams);
+    if (config.partial && !tracer.setRegion(config.region)) {
+        return 1;
+    }
     
     // Carregar cena
     if (!tracer.loadScene(config.inputFile)) {
         std::cerr << "Erro ao carregar cena: " << config.inputFile << std::endl;
         return 1;
     }
+    unsigned variant = tracer.getScene().features | (config.fastMath ? unsigned(SHADE_FAST) : 0u);
+    std::cout << "Sombreamento: variante " << shadeVariantName(variant) << std::endl;
+    
+    // Lote de câmeras: uma imagem por vista, tiles de todas no mesmo pool
+    if (!config.camerasFile.empty()) {
+        std::vector<Camera> cameras;
+        if (!loadCameras(config.camerasFile, config.aperture, config.focusDist, cameras)) {
+            return 1;
+        }
+        
+        std::cout << "Renderizando " << cameras.size() << " vistas..." << std::endl;
+        auto start = std::chrono::steady_clock::now();
+        std::atomic<bool> saved(true);
+        std::mutex outputMutex;
+        
+        // Vistas podem terminar ao mesmo tempo: só a mensagem é serializada
+        tracer.renderBatch(cameras, [&](int view, const HDRImage& image) {
+            std::string file = frameFileName(config.outputFile, view);
+            {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                std::cout << "Vista " << view << " concluída: " << file << std::endl;
+            }
+            if (!writeImage(file, image, config.toneMap, config.gamma)) saved = false;
+        });
+        
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        std::cout << "Lote: " << ms << " ms (" << ms / cameras.size() << " ms por vista)" << std::endl;
+        
+        if (!saved) {
+            std::cerr << "Erro ao salvar imagens" << std::endl;
+            return 1;
+        }
+        if (!reportStats(config, tracer, 0.0)) return 1;
+        if (!saveTrace(config)) return 1;
+        std::cout << "Concluído!" << std::endl;
+        return 0;
+    }
+    
+    // Sequência de animação
+    if (!config.animFile.empty()) {
+        Animation anim;
+        if (!loadAnimation(config.animFile, anim)) {
+            std::cerr << "Erro ao carregar animação: " << config.animFile << std::endl;
+            return 1;
+        }
+        
+        int first = config.firstFrame >= 0 ? config.firstFrame : anim.firstFrame;
+        int last = config.lastFrame >= 0 ? config.lastFrame : anim.lastFrame;
+        
+        if (!tracer.renderSequence(anim, first, last, config.outputFile)) {
+            std::cerr << "Erro ao renderizar sequência" << std::endl;
+            return 1;
+        }
+        
+        if (!saveTrace(config)) return 1;
+        std::cout << "Concluído!" << std::endl;
+        return 0;
+    }
     
     // Renderizar
-    std::cout << "Renderizando cena..." << std::endl;
-    tracer.render();
+    std::cout << "Renderizando " << config.width << "x" << config.height
+              << " com " << config.samples << " amostras..." << std::endl;
+    tracer.setIncremental(!config.editedFile.empty());
+    tracer.setGBuffer(!config.relightFile.empty());
+    tracer.setDenoise(config.denoise);
+    
+    // Saída comprimida sem pós-processamento: faixas prontas são codificadas
+    // enquanto os tiles seguintes ainda são renderizados
+    std::unique_ptr<ImageEncoder> encoder;
+    if (!config.denoise && !config.partial) encoder = tracer.createEncoder(config.outputFile);
+    
+    auto renderStart = std::chrono::steady_clock::now();
+    RenderOptions options;
+    options.onTile = [](const Region&, int done, int total) {
+        std::cout << "Progresso: " << (100 * done / total) << "%\r" << std::flush;
+    };
+    if (encoder) options.onRows = [&](int y0, int y1) { encoder->rowsReady(y0, y1); };
+    tracer.render(options);
+    double renderMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - renderStart).count();
+    std::cout << "Progresso: 100% (" << renderMs << " ms)" << std::endl;
+    
+    if (config.denoise) {
+        std::cout << "Aplicando denoiser..." << std::endl;
+        tracer.denoise();
+    }
+    
+    // Região parcial: somas e contagens para --merge
+    if (config.partial) {
+        std::cout << "Salvando parcial: " << config.outputFile << std::endl;
+        auto saveStart = std::chrono::steady_clock::now();
+        if (!tracer.savePartial(config.outputFile)) {
+            std::cerr << "Erro ao salvar parcial" << std::endl;
+            return 1;
+        }
+        double saveMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - saveStart).count();
+        if (!reportStats(config, tracer, saveMs)) return 1;
+        if (!saveTrace(config)) return 1;
+        std::cout << "Concluído!" << std::endl;
+        return 0;
+    }
     
     // Salvar imagem
     std::cout << "Salvando imagem: " << config.outputFile << std::endl;
-    if (!tracer.savePPM(config.outputFile)) {
+    auto saveStart = std::chrono::steady_clock::now();
+    if (!(encoder ? encoder->save(config.outputFile) : tracer.saveImage(config.outputFile))) {
         std::cerr << "Erro ao salvar imagem" << std::endl;
         return 1;
     }
+    double saveMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - saveStart).count();
+    if (!reportStats(config, tracer, saveMs)) return 1;
+    
+    if (!config.heatmapFile.empty()) {
+        double scale;
+        std::cout << "Salvando mapa de calor: " << config.heatmapFile << std::endl;
+        if (!tracer.saveHeatmap(config.heatmapFile, scale)) {
+            std::cerr << "Erro ao salvar mapa de calor" << std::endl;
+            return 1;
+        }
+        std::cout << "Escala (" << heatMetricName(config.heatMetric) << "): 0 a " << scale
+                  << heatMetricUnit(config.heatMetric) << " por pixel" << std::endl;
+    }
+    
+    // Cena editada: retraçar apenas os pixels invalidados
+    if (!config.editedFile.empty()) {
+        auto start = std::chrono::steady_clock::now();
+        int retraced = tracer.rerenderEdited(config.editedFile);
+        if (retraced < 0) {
+            std::cerr << "Erro ao carregar cena: " << config.editedFile << std::endl;
+            return 1;
+        }
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        
+        std::cout << "Pixels retraçados: " << retraced << "/" << config.width * config.height
+                  << " (" << ms << " ms)" << std::endl;
+        
+        std::cout << "Salvando imagem: " << config.editedOutput << std::endl;
+        if (!tracer.saveImage(config.editedOutput)) {
+            std::cerr << "Erro ao salvar imagem" << std::endl;
+            return 1;
+        }
+    }
+    
+    // Luzes/acabamentos editados: reiluminar sem lançar raios
+    if (!config.relightFile.empty()) {
+        auto start = std::chrono::steady_clock::now();
+        if (!tracer.relight(config.relightFile)) {
+            std::cerr << "Erro ao reiluminar: " << config.relightFile << std::endl;
+            return 1;
+        }
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        std::cout << "Reiluminação: " << ms << " ms" << std::endl;
+        
+        std::cout << "Salvando imagem: " << config.relightOutput << std::endl;
+        if (!tracer.saveImage(config.relightOutput)) {
+            std::cerr << "Erro ao salvar imagem" << std::endl;
+            return 1;
+        }
+    }
     
+    if (!saveTrace(config)) return 1;
     std::cout << "Concluído!" << std::endl;
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,77 @@
+// src/partial.cpp
+#include "../include/partial.hpp"
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const char* const PARTIAL_MAGIC = "RTPART";
+const int PARTIAL_VERSION = 1;
+
+} // namespace anônimo
+
+Region tileRegion(int k, int n, int w, int h) {
+    Region r;
+    r.x0 = 0;
+    r.x1 = w;
+    r.y0 = static_cast<int>(static_cast<long long>(k) * h / n);
+    r.y1 = static_cast<int>(static_cast<long long>(k + 1) * h / n);
+    return r;
+}
+
+bool savePartial(const std::string& filename, const PartialImage& part) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Erro ao criar arquivo: " << filename << std::endl;
+        return false;
+    }
+
+    const Region& r = part.region;
+    file << PARTIAL_MAGIC << " " << PARTIAL_VERSION << "\n"
+         << part.width << " " << part.height << "\n"
+         << r.x0 << " " << r.y0 << " " << r.x1 << " " << r.y1 << "\n"
+         << part.seed << "\n";
+
+    file.write(reinterpret_cast<const char*>(part.sums.data()),
+               static_cast<std::streamsize>(part.sums.size() * sizeof(float)));
+    file.write(reinterpret_cast<const char*>(part.counts.data()),
+               static_cast<std::streamsize>(part.counts.size() * sizeof(uint32_t)));
+
+    return static_cast<bool>(file);
+}
+
+bool loadPartial(const std::string& filename, PartialImage& part) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Erro ao abrir parcial: " << filename << std::endl;
+        return false;
+    }
+
+    std::string magic;
+    int version;
+    Region& r = part.region;
+    if (!(file >> magic >> version) || magic != PARTIAL_MAGIC || version != PARTIAL_VERSION) {
+        std::cerr << "Formato de parcial inválido: " << filename << std::endl;
+        return false;
+    }
+    if (!(file >> part.width >> part.height >> r.x0 >> r.y0 >> r.x1 >> r.y1 >> part.seed) ||
+        r.x0 < 0 || r.y0 < 0 || r.x1 > part.width || r.y1 > part.height || r.empty()) {
+        std::cerr << "Cabeçalho de parcial inválido: " << filename << std::endl;
+        return false;
+    }
+    file.get(); // '\n' antes dos dados binários
+
+    size_t n = static_cast<size_t>(r.width()) * r.height();
+    part.sums.resize(n * 3);
+    part.counts.resize(n);
+    file.read(reinterpret_cast<char*>(part.sums.data()),
+              static_cast<std::streamsize>(part.sums.size() * sizeof(float)));
+    file.read(reinterpret_cast<char*>(part.counts.data()),
+              static_cast<std::streamsize>(part.counts.size() * sizeof(uint32_t)));
+
+    if (!file) {
+        std::cerr << "Parcial truncada: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -19,10 +19,10 @@ Vec3 getPigmentColor(const Pigment& pigment, const Vec3& point) {
         case TEXMAP: {
             if (pigment.textureData.empty()) return Vec3(1, 1, 1);
             
-            double px = point.x, py = point.y, pz = point.z, pw = 1.0;
+            Real px = point.x, py = point.y, pz = point.z, pw = 1;
             
-            double s = pigment.p0[0]*px + pigment.p0[1]*py + pigment.p0[2]*pz + pigment.p0[3]*pw;
-            double t = pigment.p1[0]*px + pigment.p1[1]*py + pigment.p1[2]*pz + pigment.p1[3]*pw;
+            Real s = pigment.p0[0]*px + pigment.p0[1]*py + pigment.p0[2]*pz + pigment.p0[3]*pw;
+            Real t = pigment.p1[0]*px + pigment.p1[1]*py + pigment.p1[2]*pz + pigment.p1[3]*pw;
             
             s = s - std::floor(s);
             t = t - std::floor(t);
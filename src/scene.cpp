@@ -1,18 +1,304 @@
 // src/scene.cpp
 #include "../include/scene.hpp"
+#include <algorithm>
 #include <cmath>
 
-Plane::Plane(double a, double b, double c, double d) 
+Plane::Plane(Real a, Real b, Real c, Real d) 
     : a(a), b(b), c(c), d(d) {
     normalize();
 }
 
 void Plane::normalize() {
-    double len = std::sqrt(a*a + b*b + c*c);
+    Real len = std::sqrt(a*a + b*b + c*c);
     if (len > 0) {
         a /= len; 
         b /= len; 
         c /= len; 
         d /= len;
     }
-}
\ No newline at end of file
+}
+
+void PlaneSoA::assign(const std::vector<Plane>& planes) {
+    size_t padded = (planes.size() + PLANE_LANES - 1) / PLANE_LANES * PLANE_LANES;
+    a.assign(padded, 0);
+    b.assign(padded, 0);
+    c.assign(padded, 0);
+    d.assign(padded, -1);
+    for (size_t i = 0; i < planes.size(); i++) {
+        a[i] = planes[i].a;
+        b[i] = planes[i].b;
+        c[i] = planes[i].c;
+        d[i] = planes[i].d;
+    }
+}
+
+// Transladar a geometria de um objeto
+void translateObject(Object& obj, const Vec3& offset) {
+    switch (obj.type) {
+        case SPHERE:
+            obj.sphere.center = obj.sphere.center + offset;
+            break;
+            
+        case POLYHEDRON:
+            // n·(p - t) + d = n·p + (d - n·t)
+            for (auto& plane : obj.faces) {
+                plane.d -= plane.normal().dot(offset);
+            }
+            obj.faceSoA.assign(obj.faces);
+            break;
+            
+        case TRIANGLE:
+            obj.triangle.v0 = obj.triangle.v0 + offset;
+            obj.triangle.v1 = obj.triangle.v1 + offset;
+            obj.triangle.v2 = obj.triangle.v2 + offset;
+            break;
+            
+        case CYLINDER:
+        case CONE:
+            obj.cylinderCone.base = obj.cylinderCone.base + offset;
+            break;
+            
+        case QUADRIC: {
+            // Substituir p por (p - t) e reagrupar os coeficientes
+            auto& q = obj.quadric;
+            Real tx = offset.x, ty = offset.y, tz = offset.z;
+            Real J = q.A*tx*tx + q.B*ty*ty + q.C*tz*tz +
+                       q.D*tx*ty + q.E*tx*tz + q.F*ty*tz -
+                       q.G*tx - q.H*ty - q.I*tz + q.J;
+            Real G = q.G - 2*q.A*tx - q.D*ty - q.E*tz;
+            Real H = q.H - 2*q.B*ty - q.D*tx - q.F*tz;
+            Real I = q.I - 2*q.C*tz - q.E*tx - q.F*ty;
+            q.G = G; q.H = H; q.I = I; q.J = J;
+            
+            if (q.clipBox.valid()) {
+                q.clipBox.min = q.clipBox.min + offset;
+                q.clipBox.max = q.clipBox.max + offset;
+            }
+            for (auto& plane : q.clipPlanes) {
+                plane.d -= plane.normal().dot(offset);
+            }
+            classifyQuadric(obj);
+            break;
+        }
+    }
+}
+
+namespace {
+
+Vec3 toVec3(const Real v[3]) { return Vec3(v[0], v[1], v[2]); }
+
+Real minOf(const AABB& box, int axis) {
+    return axis == 0 ? box.min.x : axis == 1 ? box.min.y : box.min.z;
+}
+
+Real maxOf(const AABB& box, int axis) {
+    return axis == 0 ? box.max.x : axis == 1 ? box.max.y : box.max.z;
+}
+
+Vec3 unitAxis(int axis, Real sign) {
+    Real v[3] = {0, 0, 0};
+    v[axis] = sign;
+    return toVec3(v);
+}
+
+// A caixa contém o disco de raio r em torno de c nos eixos diferentes de 'axis'?
+bool coversDisc(const AABB& box, int axis, const Real c[3], Real r) {
+    for (int i = 0; i < 3; i++) {
+        if (i == axis) continue;
+        if (minOf(box, i) > c[i] - r || maxOf(box, i) < c[i] + r) return false;
+    }
+    return true;
+}
+
+// Cilindro circular cortado só por caixa que cobre toda a seção: o corte
+// equivale à altura do cilindro nativo (sem tampas, como a quádrica)
+bool rewriteCylinder(Object& obj, int axis, const Real a[3], const Real c[3], Real K) {
+    const QuadricData& q = obj.quadric;
+    if (!q.clipBox.valid() || !q.clipPlanes.empty()) return false;
+    
+    int i = (axis + 1) % 3, j = (axis + 2) % 3;
+    if (a[i] != a[j]) return false;
+    
+    Real r = std::sqrt(-K / a[i]);
+    if (!coversDisc(q.clipBox, axis, c, r)) return false;
+    
+    Real base[3] = {c[0], c[1], c[2]};
+    base[axis] = minOf(q.clipBox, axis);
+    obj.type = CYLINDER;
+    obj.cylinderCone.base = toVec3(base);
+    obj.cylinderCone.axis = unitAxis(axis, 1);
+    obj.cylinderCone.height = maxOf(q.clipBox, axis) - base[axis];
+    obj.cylinderCone.radius1 = r;
+    obj.cylinderCone.radius2 = r;
+    return true;
+}
+
+// Cone circular cortado por caixa com uma face no ápice: sobra uma só folha,
+// que é o cone nativo (ápice em base, eixo apontando para dentro da caixa)
+bool rewriteCone(Object& obj, int axis, const Real a[3], const Real c[3]) {
+    const QuadricData& q = obj.quadric;
+    if (!q.clipBox.valid() || !q.clipPlanes.empty()) return false;
+    
+    int i = (axis + 1) % 3, j = (axis + 2) % 3;
+    if (a[i] != a[j]) return false;
+    
+    Real lo = minOf(q.clipBox, axis), hi = maxOf(q.clipBox, axis);
+    Real sign, height;
+    if (std::fabs(lo - c[axis]) <= EPSILON) {
+        sign = 1;
+        height = hi - c[axis];
+    } else if (std::fabs(hi - c[axis]) <= EPSILON) {
+        sign = -1;
+        height = c[axis] - lo;
+    } else {
+        return false;
+    }
+    if (height <= EPSILON) return false;
+    
+    // u_i² + u_j² = (-a_k / a_i)·u_k²: raio = inclinação × altura
+    Real r = std::sqrt(-a[axis] / a[i]) * height;
+    if (!coversDisc(q.clipBox, axis, c, r)) return false;
+    
+    obj.type = CONE;
+    obj.cylinderCone.base = toVec3(c);
+    obj.cylinderCone.axis = unitAxis(axis, sign);
+    obj.cylinderCone.height = height;
+    obj.cylinderCone.radius1 = r;
+    return true;
+}
+
+} // namespace anônimo
+
+bool classifyQuadric(Object& obj) {
+    if (obj.type != QUADRIC) return false;
+    
+    QuadricData& q = obj.quadric;
+    q.shape = QUADRIC_GENERAL;
+    q.kernel = QKERNEL_GENERAL;
+    
+    // Termos cruzados: eixos girados, fica o núcleo geral
+    if (q.D != 0 || q.E != 0 || q.F != 0) return false;
+    
+    // Completar quadrados: a_i·x_i² + g_i·x_i = a_i·(x_i - c_i)² - a_i·c_i²
+    Real a[3] = {q.A, q.B, q.C};
+    Real g[3] = {q.G, q.H, q.I};
+    Real c[3] = {0, 0, 0};
+    Real K = q.J;
+    Real magnitude = std::fabs(q.J);
+    int quadratic = 0;
+    for (int i = 0; i < 3; i++) {
+        if (a[i] == 0) continue;
+        c[i] = -g[i] / (2 * a[i]);
+        K -= a[i] * c[i] * c[i];
+        magnitude += std::fabs(a[i] * c[i] * c[i]);
+        g[i] = 0;
+        quadratic++;
+    }
+    // Constante que só sobra do arredondamento (cones)
+    if (std::fabs(K) <= EPSILON * std::max(Real(1), magnitude)) K = 0;
+    
+    // Sinal com a maioria dos termos quadráticos positiva
+    int positive = 0;
+    for (int i = 0; i < 3; i++) positive += a[i] > 0;
+    if (2 * positive < quadratic) {
+        for (int i = 0; i < 3; i++) {
+            a[i] = -a[i];
+            g[i] = -g[i];
+        }
+        K = -K;
+        positive = quadratic - positive;
+    }
+    
+    int flat = -1;   // Eixo sem termo quadrático (quando há um só)
+    for (int i = 0; i < 3; i++) if (a[i] == 0) flat = i;
+    
+    switch (quadratic) {
+        case 0:
+            if (g[0] == 0 && g[1] == 0 && g[2] == 0) return false;
+            q.shape = QUADRIC_PLANE;
+            break;
+        case 3:
+            if (positive < 3) q.shape = K == 0 ? QUADRIC_CONE : QUADRIC_HYPERBOLOID;
+            else if (K >= 0) q.shape = QUADRIC_OTHER;   // Vazia ou um ponto
+            else if (a[0] == a[1] && a[1] == a[2]) q.shape = QUADRIC_SPHERE;
+            else q.shape = QUADRIC_ELLIPSOID;
+            break;
+        case 2:
+            if (g[flat] != 0) {
+                // Absorver a constante no centro ao longo do eixo livre
+                c[flat] = -K / g[flat];
+                K = 0;
+                q.shape = QUADRIC_PARABOLOID;
+            } else if (positive == 2 && K < 0) {
+                q.shape = QUADRIC_CYLINDER;
+            } else {
+                q.shape = QUADRIC_OTHER;
+            }
+            break;
+        default:
+            q.shape = QUADRIC_OTHER;   // Cilindros parabólicos, pares de planos
+            break;
+    }
+    
+    q.center = toVec3(c);
+    q.diag = toVec3(a);
+    q.linear = toVec3(g);
+    q.constant = K;
+    
+    switch (q.shape) {
+        case QUADRIC_SPHERE:
+            if (!q.clipped()) {
+                obj.type = SPHERE;
+                obj.sphere.center = q.center;
+                obj.sphere.radius = std::sqrt(-K / a[0]);
+                return true;
+            }
+            [[fallthrough]];
+        case QUADRIC_ELLIPSOID:
+            q.kernel = QKERNEL_ELLIPSOID;
+            q.diag = Vec3(std::sqrt(a[0] / -K), std::sqrt(a[1] / -K), std::sqrt(a[2] / -K));
+            q.constant = -1;
+            return false;
+        case QUADRIC_CYLINDER:
+            if (rewriteCylinder(obj, flat, a, c, K)) return true;
+            break;
+        case QUADRIC_CONE: {
+            // Eixo do cone: o termo de sinal oposto aos outros dois
+            int axis = a[0] < 0 ? 0 : a[1] < 0 ? 1 : 2;
+            if (rewriteCone(obj, axis, a, c)) return true;
+            break;
+        }
+        case QUADRIC_PLANE:
+            q.kernel = QKERNEL_PLANE;
+            return false;
+        default:
+            break;
+    }
+    
+    q.kernel = QKERNEL_AXIS;
+    return false;
+}
+
+void classifyQuadrics(Scene& scene) {
+    std::fill(scene.quadricClasses, scene.quadricClasses + QUADRIC_CLASS_COUNT, 0);
+    std::fill(scene.quadricRewritten, scene.quadricRewritten + QUADRIC_CLASS_COUNT, 0);
+    
+    for (Object& obj : scene.objects) {
+        if (obj.type != QUADRIC) continue;
+        bool rewritten = classifyQuadric(obj);
+        QuadricClass shape = obj.quadric.shape;
+        scene.quadricClasses[shape]++;
+        if (rewritten) scene.quadricRewritten[shape]++;
+    }
+}
+
+unsigned shadeFeatures(const Scene& scene) {
+    unsigned features = 0;
+    for (const Object& obj : scene.objects) {
+        const Finish& finish = scene.finishes[obj.finishIdx];
+        if (finish.kr > 0) features |= SHADE_REFLECTION;
+        if (finish.kt > 0) features |= SHADE_REFRACTION;
+        if (scene.pigments[obj.pigmentIdx].type != SOLID) features |= SHADE_PATTERN;
+    }
+    return features;
+}
@@ -0,0 +1,395 @@
+// src/server.cpp
+#include "../include/server.hpp"
+#include "../include/raytracer.hpp"
+#include "../include/loader.hpp"
+#include "../include/bvh.hpp"
+#include "../include/threadpool.hpp"
+#include <sys/stat.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using ScenePtr = std::shared_ptr<const Scene>;
+
+// Limites de um trabalho: acima disso a imagem nem caberia na memória, e uma
+// alocação falha derrubaria o servidor com as sessões dos outros clientes
+constexpr int MAX_JOB_SIDE = 16384;
+constexpr long long MAX_JOB_PIXELS = 8192LL * 8192;
+constexpr int MAX_JOB_SAMPLES = 4096;
+
+// Cache de cenas carregadas, invalidado pela data de modificação do arquivo.
+// Pedidos simultâneos da mesma cena compartilham um único carregamento.
+class SceneCache {
+private:
+    struct Entry {
+        long long mtime;
+        std::shared_future<ScenePtr> scene;
+    };
+    std::map<std::string, Entry> entries;
+    std::mutex mutex;
+
+    static long long modificationTime(const std::string& path) {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) return -1;
+        return static_cast<long long>(st.st_mtime);
+    }
+
+public:
+    // Retorna nullptr se a cena não puder ser carregada; 'cached' indica acerto
+    ScenePtr get(const std::string& path, bool& cached) {
+        long long mtime = modificationTime(path);
+        std::promise<ScenePtr> promise;
+        std::shared_future<ScenePtr> future;
+        bool load = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(path);
+            if (it != entries.end() && it->second.mtime == mtime) {
+                future = it->second.scene;
+            } else {
+                future = promise.get_future().share();
+                entries[path] = Entry{ mtime, future };
+                load = true;
+            }
+        }
+        cached = !load;
+
+        if (load) {
+            auto scene = std::make_shared<Scene>();
+            if (::loadScene(path, *scene)) {
+                buildBVH(*scene);
+                promise.set_value(scene);
+            } else {
+                promise.set_value(nullptr);
+                evict(path);
+            }
+        }
+
+        return future.get();
+    }
+
+    void evict(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.erase(path);
+    }
+};
+
+SceneCache& sceneCache() {
+    static SceneCache cache;
+    return cache;
+}
+
+// Canal bidirecional de uma sessão
+class Channel {
+public:
+    virtual ~Channel() {}
+    virtual bool readLine(std::string& line) = 0;
+    virtual void write(const void* data, size_t size) = 0;
+};
+
+class StdioChannel : public Channel {
+public:
+    bool readLine(std::string& line) override {
+        return static_cast<bool>(std::getline(std::cin, line));
+    }
+    void write(const void* data, size_t size) override {
+        std::fwrite(data, 1, size, stdout);
+        std::fflush(stdout);
+    }
+};
+
+#ifndef _WIN32
+class SocketChannel : public Channel {
+private:
+    int fd;
+    std::string buffer;
+
+public:
+    explicit SocketChannel(int fd) : fd(fd) {}
+    ~SocketChannel() override { ::close(fd); }
+
+    bool readLine(std::string& line) override {
+        for (;;) {
+            size_t pos = buffer.find('\n');
+            if (pos != std::string::npos) {
+                line = buffer.substr(0, pos);
+                buffer.erase(0, pos + 1);
+                return true;
+            }
+            char chunk[4096];
+            ssize_t n = ::read(fd, chunk, sizeof(chunk));
+            if (n <= 0) return false;
+            buffer.append(chunk, static_cast<size_t>(n));
+        }
+    }
+
+    void write(const void* data, size_t size) override {
+        const char* p = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t n = ::write(fd, p, size);
+            if (n <= 0) return;
+            p += n;
+            size -= static_cast<size_t>(n);
+        }
+    }
+};
+#endif
+
+// Trabalho de renderização descrito por uma linha "render ..."
+struct Job {
+    std::string id;
+    std::string scenePath;
+    int width = 0, height = 0, samples = 0;
+    double aperture = 0.0, focusDist = 10.0;
+    uint64_t seed = 0;
+    ToneMap toneMap = TONEMAP_CLAMP;
+    double gamma = 1.0;
+
+    // Sobrescritas de câmera
+    bool hasEye = false, hasLookAt = false, hasUp = false, hasFovy = false;
+    Vec3 eye, lookAt, up;
+    double fovy = 0.0;
+};
+
+bool parseVec3(const std::string& text, Vec3& v) {
+    double x, y, z;
+    if (std::sscanf(text.c_str(), "%lf,%lf,%lf", &x, &y, &z) != 3) return false;
+    v = Vec3(x, y, z);
+    return true;
+}
+
+bool parseJob(std::istringstream& in, Job& job, std::string& error) {
+    if (!(in >> job.id >> job.scenePath >> job.width >> job.height >> job.samples)) {
+        error = "requisição incompleta";
+        return false;
+    }
+    if (job.width <= 0 || job.height <= 0 || job.samples <= 0) {
+        error = "resolução ou amostras inválidas";
+        return false;
+    }
+    if (job.width > MAX_JOB_SIDE || job.height > MAX_JOB_SIDE ||
+        static_cast<long long>(job.width) * job.height > MAX_JOB_PIXELS ||
+        job.samples > MAX_JOB_SAMPLES) {
+        error = "resolução ou amostras acima do limite";
+        return false;
+    }
+
+    std::string option;
+    while (in >> option) {
+        size_t eq = option.find('=');
+        if (eq == std::string::npos) {
+            error = "opção sem valor: " + option;
+            return false;
+        }
+        std::string key = option.substr(0, eq);
+        std::string value = option.substr(eq + 1);
+
+        bool ok = true;
+        if (key == "eye") ok = job.hasEye = parseVec3(value, job.eye);
+        else if (key == "lookat") ok = job.hasLookAt = parseVec3(value, job.lookAt);
+        else if (key == "up") ok = job.hasUp = parseVec3(value, job.up);
+        else if (key == "fovy") { job.fovy = std::atof(value.c_str()); job.hasFovy = true; }
+        else if (key == "aperture") job.aperture = std::atof(value.c_str());
+        else if (key == "focus") job.focusDist = std::atof(value.c_str());
+        else if (key == "seed") job.seed = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "tonemap") ok = parseToneMap(value, job.toneMap);
+        else if (key == "gamma") job.gamma = std::atof(value.c_str());
+        else ok = false;
+
+        if (!ok) {
+            error = "opção inválida: " + option;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Estado de uma sessão: respostas serializadas e contagem de trabalhos pendentes
+class Session {
+private:
+    Channel& channel;
+    std::mutex writeMutex;
+    std::mutex pendingMutex;
+    std::condition_variable idle;
+    int pending = 0;
+
+    void reply(const std::string& header, const std::vector<unsigned char>* body = nullptr) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        channel.write(header.data(), header.size());
+        if (body) channel.write(body->data(), body->size());
+    }
+
+    void renderJob(const Job& job) {
+        auto start = std::chrono::steady_clock::now();
+
+        bool cached;
+        ScenePtr scene = sceneCache().get(job.scenePath, cached);
+        if (!scene) {
+            reply("error " + job.id + " falha ao carregar cena: " + job.scenePath + "\n");
+            return;
+        }
+
+        RayTracer tracer(job.width, job.height, job.samples);
+        tracer.setDOF(job.aperture, job.focusDist);
+        tracer.setSeed(job.seed);
+        tracer.setToneMap(job.toneMap, job.gamma > 0 ? job.gamma : 1.0);
+        tracer.setScene(scene);   // Compartilhada com a cache, sem cópia
+
+        if (job.hasEye || job.hasLookAt || job.hasUp || job.hasFovy) {
+            Camera view = sceneCamera(*scene, job.aperture, job.focusDist);
+            if (job.hasEye) view.eye = job.eye;
+            if (job.hasLookAt) view.lookAt = job.lookAt;
+            if (job.hasUp) view.up = job.up;
+            if (job.hasFovy) view.fovy = job.fovy;
+            tracer.setCamera(view);
+        }
+
+        tracer.render();
+        std::vector<unsigned char> image = tracer.encodePPM();
+
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        std::ostringstream header;
+        header << "ok " << job.id << " " << static_cast<long long>(ms) << " " << image.size() << "\n";
+        reply(header.str(), &image);
+
+        std::cerr << "Trabalho " << job.id << ": " << job.scenePath
+                  << (cached ? " (cache)" : " (carregada)") << ", " << ms << " ms" << std::endl;
+    }
+
+    // Nenhuma exceção sai da tarefa do pool: ela terminaria o processo inteiro
+    void runJob(const Job& job) {
+        try {
+            renderJob(job);
+        } catch (const std::exception& e) {
+            reply("error " + job.id + " " + e.what() + "\n");
+        } catch (...) {
+            reply("error " + job.id + " erro desconhecido\n");
+        }
+    }
+
+public:
+    explicit Session(Channel& channel) : channel(channel) {}
+
+    void run() {
+        std::string line;
+        while (channel.readLine(line)) {
+            std::istringstream in(line);
+            std::string command;
+            if (!(in >> command)) continue;
+
+            if (command == "quit") break;
+
+            if (command == "evict") {
+                std::string path;
+                in >> path;
+                sceneCache().evict(path);
+                reply("ok evict " + path + "\n");
+                continue;
+            }
+
+            if (command != "render") {
+                reply("error - comando desconhecido: " + command + "\n");
+                continue;
+            }
+
+            auto job = std::make_shared<Job>();
+            std::string error;
+            if (!parseJob(in, *job, error)) {
+                reply("error " + (job->id.empty() ? "-" : job->id) + " " + error + "\n");
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(pendingMutex);
+                pending++;
+            }
+            ThreadPool::global().submit([this, job] {
+                runJob(*job);   // Não lança: pending é decrementado em todo caminho
+                std::lock_guard<std::mutex> lock(pendingMutex);
+                if (--pending == 0) idle.notify_all();
+            });
+        }
+
+        // Aguardar os trabalhos em andamento antes de fechar o canal
+        std::unique_lock<std::mutex> lock(pendingMutex);
+        idle.wait(lock, [this] { return pending == 0; });
+    }
+};
+
+} // namespace anônimo
+
+int runStdioServer() {
+    std::cerr << "Servidor em stdin/stdout (" << ThreadPool::global().size() + 1
+              << " threads)" << std::endl;
+    StdioChannel channel;
+    Session session(channel);
+    session.run();
+    return 0;
+}
+
+#ifndef _WIN32
+int runSocketServer(const std::string& path) {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Caminho de socket muito longo: " << path << std::endl;
+        return 1;
+    }
+    path.copy(addr.sun_path, path.size());
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::cerr << "Erro ao criar socket" << std::endl;
+        return 1;
+    }
+
+    ::unlink(path.c_str());
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listener, 16) != 0) {
+        std::cerr << "Erro ao escutar em " << path << std::endl;
+        ::close(listener);
+        return 1;
+    }
+
+    std::cerr << "Servidor em " << path << " (" << ThreadPool::global().size() + 1
+              << " threads)" << std::endl;
+
+    // Cada conexão lê requisições em sua própria thread; a renderização
+    // acontece no pool compartilhado
+    for (;;) {
+        int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) continue;
+        std::thread([fd] {
+            SocketChannel channel(fd);
+            Session session(channel);
+            session.run();
+        }).detach();
+    }
+}
+#else
+int runSocketServer(const std::string& path) {
+    std::cerr << "Socket Unix indisponível nesta plataforma: " << path << std::endl;
+    return 1;
+}
+#endif
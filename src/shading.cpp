@@ -2,15 +2,75 @@
 #include "../include/shading.hpp"
 #include "../include/intersect.hpp"
 #include "../include/pigment.hpp"
+#include "../include/rng.hpp"
 #include <cmath>
+#include <cstring>
 #include <algorithm>
+#include <string>
+#include <vector>
+#ifdef __SSE__
+#include <immintrin.h>
+#endif
 
 namespace {
 
+// Aproximações do modo rápido (--fast-math). Só entram no cálculo de cor:
+// direções de raios e testes de sombra são os mesmos do caminho de referência,
+// então a visibilidade não muda e o erro fica limitado (ver readme).
+
+// x^n por quadrados sucessivos: ~2·log2(n) multiplicações em vez de exp/log
+inline Real powInt(Real x, unsigned n) {
+    Real result = 1;
+    while (n) {
+        if (n & 1) result *= x;
+        x *= x;
+        n >>= 1;
+    }
+    return result;
+}
+
+// Expoente de Phong inteiro (o caso comum) sem std::pow
+inline Real fastPow(Real x, Real alpha) {
+    if (x <= 0) return alpha == 0 ? Real(1) : Real(0);
+    if (alpha >= 0 && alpha <= 65535 && alpha == std::floor(alpha)) {
+        return powInt(x, static_cast<unsigned>(alpha));
+    }
+    return std::pow(x, alpha);
+}
+
+// 1/sqrt(x): estimativa de 12 bits do hardware e um passo de Newton
+// (erro relativo < 2e-7)
+inline Real fastRsqrt(Real x) {
+#ifdef __SSE__
+    Real r = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(static_cast<float>(x))));
+    return r * (Real(1.5) - Real(0.5) * x * r * r);
+#else
+    return 1 / std::sqrt(x);
+#endif
+}
+
+inline Vec3 fastNormalize(const Vec3& v) {
+    Real len2 = v.lengthSquared();
+    return len2 > 0 ? v * fastRsqrt(len2) : v;
+}
+
+// Direção e distância até uma luz, calculadas uma vez e usadas pela sombra
+// e pelos termos de Phong
+struct LightSample {
+    Vec3 dir;
+    Real dist;
+};
+
+inline LightSample sampleLight(const Light& light, const Vec3& point) {
+    Vec3 toLight = light.position - point;
+    Real dist = toLight.length();
+    return { dist > 0 ? toLight / dist : toLight, dist };
+}
+
 // Refração usando Lei de Snell
-bool refract(const Vec3& incident, const Vec3& normal, double ior, Vec3& refracted) {
-    double cosi = incident.dot(normal);
-    double etai = 1.0, etat = ior;
+bool refract(const Vec3& incident, const Vec3& normal, Real ior, Vec3& refracted) {
+    Real cosi = incident.dot(normal);
+    Real etai = 1, etat = ior;
     Vec3 n = normal;
     
     if (cosi < 0) {
@@ -20,8 +80,8 @@ bool refract(const Vec3& incident, const Vec3& normal, double ior, Vec3& refract
         n = -normal;
     }
     
-    double eta = etai / etat;
-    double k = 1.0 - eta * eta * (1.0 - cosi * cosi);
+    Real eta = etai / etat;
+    Real k = 1 - eta * eta * (1 - cosi * cosi);
     
     if (k < 0) return false; // Reflexão total interna
     
@@ -30,89 +90,242 @@ bool refract(const Vec3& incident, const Vec3& normal, double ior, Vec3& refract
 }
 
 // Calcular atenuação da luz
-inline double calculateAttenuation(const Light& light, double distance) {
-    return 1.0 / (light.attenuation.x + 
+inline Real calculateAttenuation(const Light& light, Real distance) {
+    return 1 / (light.attenuation.x + 
                   light.attenuation.y * distance + 
                   light.attenuation.z * distance * distance);
 }
 
+// Último oclusor encontrado, em cada thread, por (luz, profundidade): pontos
+// vizinhos costumam ser sombreados pelo mesmo objeto. É só uma dica (qualquer
+// objeto antes da luz basta), então valores de outra cena não causam erro.
+thread_local std::vector<int> lastOccluder;
+
+inline size_t occluderSlot(size_t lightIdx, int depth) {
+    return lightIdx * (MAX_DEPTH + 1) + depth;
+}
+
 // Verificar se ponto está em sombra
-bool isInShadow(const Vec3& point, const Vec3& normal, const Light& light, const Scene& scene) {
-    Vec3 lightDir = (light.position - point).normalize();
-    double lightDist = (light.position - point).length();
+bool isInShadow(const Vec3& point, const Vec3& normal, size_t slot,
+                const LightSample& toLight, const Scene& scene, TraceContext* ctx) {
+    RenderStats* stats = ctx ? ctx->stats : nullptr;
+    if (stats) stats->shadowRays++;
+    
+    Ray shadowRay(offsetOrigin(point, normal), toLight.dir);
+    const Real maxT = toLight.dist - SHADOW_BIAS;
     
-    Ray shadowRay(point + normal * SHADOW_BIAS, lightDir);
-    HitInfo shadowHit = findClosestHit(shadowRay, scene);
+    if (lastOccluder.size() <= slot) lastOccluder.resize(slot + 1, -1);
+    int& cached = lastOccluder[slot];
     
-    return shadowHit.hit && shadowHit.t < lightDist - SHADOW_BIAS;
+    HitInfo shadowHit;
+    bool shadowed = false;
+    if (cached >= 0 && cached < static_cast<int>(scene.objects.size()) &&
+        intersectObject(shadowRay, scene, cached, shadowHit, stats) && shadowHit.t < maxT) {
+        if (stats) stats->shadowCacheHits++;
+        shadowed = true;
+    } else {
+        if (stats) stats->shadowCacheMisses++;
+        shadowHit = findClosestHit(shadowRay, scene, stats);
+        shadowed = shadowHit.hit && shadowHit.t < maxT;
+        // Ponto iluminado: vizinhos provavelmente também, não testar o antigo oclusor
+        cached = shadowed ? shadowHit.objectIdx : -1;
+    }
+    
+    // O segmento até a luz fica implícito: parte de um ponto já registrado
+    if (shadowed && ctx && ctx->recording()) ctx->recordHit(shadowHit.objectIdx);
+    
+    return shadowed;
 }
 
 // Componente ambiente
-Vec3 calculateAmbient(const Vec3& baseColor, const Light& ambientLight, double ka) {
+Vec3 calculateAmbient(const Vec3& baseColor, const Light& ambientLight, Real ka) {
     return baseColor.mul(ambientLight.color) * ka;
 }
 
 // Componente difusa
 Vec3 calculateDiffuse(const Vec3& baseColor, const Vec3& normal, const Vec3& lightDir,
-                      const Light& light, double kd, double attenuation) {
-    double diff = std::max(0.0, normal.dot(lightDir));
+                      const Light& light, Real kd, Real attenuation) {
+    Real diff = std::max(Real(0), normal.dot(lightDir));
     return baseColor.mul(light.color) * (kd * diff * attenuation);
 }
 
 // Componente especular (Phong)
+template<unsigned F>
 Vec3 calculateSpecular(const Vec3& normal, const Vec3& lightDir, const Vec3& viewDir,
-                       const Light& light, double ks, double alpha, double attenuation) {
+                       const Light& light, Real ks, Real alpha, Real attenuation) {
     Vec3 reflectDir = lightDir.reflect(normal);
-    double spec = std::pow(std::max(0.0, viewDir.dot(reflectDir)), alpha);
+    Real cosR = std::max(Real(0), viewDir.dot(reflectDir));
+    Real spec;
+    if constexpr ((F & SHADE_FAST) != 0) spec = fastPow(cosR, alpha);
+    else spec = std::pow(cosR, alpha);
     return light.color * (ks * spec * attenuation);
 }
 
+// Difusa + especular de uma luz visível
+template<unsigned F>
+Vec3 lightTerm(const Vec3& baseColor, const Vec3& normal, const Vec3& viewDir,
+               const Light& light, const LightSample& toLight, const Finish& finish) {
+    Real atten = calculateAttenuation(light, toLight.dist);
+    return calculateDiffuse(baseColor, normal, toLight.dir, light, finish.kd, atten) +
+           calculateSpecular<F>(normal, toLight.dir, viewDir, light, finish.ks, finish.alpha, atten);
+}
+
+// Cor do pigmento; sem SHADE_PATTERN todos os pigmentos são sólidos
+template<unsigned F>
+inline Vec3 baseColorAt(const Pigment& pigment, const Vec3& point) {
+    if constexpr ((F & SHADE_PATTERN) != 0) return getPigmentColor(pigment, point);
+    else return pigment.color1;
+}
+
+template<unsigned F>
+Vec3 trace(const Ray& ray, const Scene& scene, int depth, TraceContext* ctx);
+
+template<unsigned F>
+Vec3 shade(const HitInfo& hit, const Scene& scene, const Ray& ray, int depth, TraceContext* ctx);
+
+// Chave do ponto para a semente do hemisfério: a mesma amostra sai na
+// pré-passada e num cálculo sob demanda, em qualquer thread
+uint64_t pointKey(const Vec3& p) {
+    double c[3] = { static_cast<double>(p.x), static_cast<double>(p.y), static_cast<double>(p.z) };
+    uint64_t bits[3];
+    std::memcpy(bits, c, sizeof(bits));
+    return Rng::mix(bits[0] ^ Rng::mix(bits[1] ^ Rng::mix(bits[2])));
+}
+
+// Base ortonormal em torno da normal
+void tangentFrame(const Vec3& n, Vec3& t, Vec3& b) {
+    Vec3 helper = std::fabs(n.x) > Real(0.9) ? Vec3(0, 1, 0) : Vec3(1, 0, 0);
+    t = helper.cross(n).normalize();
+    b = n.cross(t);
+}
+
+// Hemisfério estratificado com densidade cosseno (estratos θ:φ ≈ 1:π, como em
+// Ward): a média das radiâncias estima irradiância/π. Cada raio vê a cena com o
+// sombreamento normal, sem luz indireta própria (um rebatimento).
+template<unsigned F>
+IrradianceRecord sampleHemisphere(const Vec3& point, const Vec3& normal, int depth,
+                                  const Scene& scene, const IrradianceCache& cache,
+                                  TraceContext* ctx) {
+    IrradianceRecord record;
+    record.point = point;
+    record.normal = normal;
+    if (depth >= MAX_DEPTH) return record;
+    
+    TraceContext nested;
+    nested.stats = ctx ? ctx->stats : nullptr;
+    nested.fastMath = ctx && ctx->fastMath;
+    
+    const int rays = std::max(1, cache.params.rays);
+    const int thetaStrata = std::max(1, static_cast<int>(std::lround(std::sqrt(rays / M_PI))));
+    const int phiStrata = std::max(1, rays / thetaStrata);
+    
+    Vec3 t, b;
+    tangentFrame(normal, t, b);
+    const Vec3 origin = offsetOrigin(point, normal);
+    Rng rng(cache.seed, pointKey(point));
+    
+    Vec3 sum(0, 0, 0);
+    Real inverseDistances = 0;
+    for (int j = 0; j < thetaStrata; j++) {
+        for (int k = 0; k < phiStrata; k++) {
+            Real u1 = (j + static_cast<Real>(rng.next())) / thetaStrata;
+            Real u2 = (k + static_cast<Real>(rng.next())) / phiStrata;
+            Real sinTheta = std::sqrt(u1);
+            Real cosTheta = std::sqrt(1 - u1);
+            Real phi = Real(2 * M_PI) * u2;
+            Vec3 dir = t * (sinTheta * std::cos(phi)) + b * (sinTheta * std::sin(phi)) +
+                       normal * cosTheta;
+            
+            Ray ray(origin, dir);
+            if (nested.stats) nested.stats->irradianceRays++;
+            HitInfo hit = findClosestHit(ray, scene, nested.stats);
+            if (hit.hit) {
+                sum = sum + shade<F>(hit, scene, ray, depth + 1, &nested);
+                inverseDistances += 1 / std::max(hit.t, EPSILON);
+            } else {
+                sum = sum + backgroundColor();
+            }
+        }
+    }
+    
+    const int count = thetaStrata * phiStrata;
+    record.value = sum / static_cast<Real>(count);
+    record.radius = inverseDistances > 0 ? count / inverseDistances
+                                         : std::numeric_limits<Real>::max();
+    return record;
+}
+
+// Luz indireta difusa (irradiância/π) no ponto: da cache quando algum
+// registro cobre o ponto, senão amostrada na hora (sem guardar: a cache é
+// só leitura durante a renderização). Pontos vistos por reflexão/refração
+// pesam menos na imagem e toleram erro proporcional à profundidade.
+template<unsigned F>
+Vec3 indirectDiffuse(const HitInfo& hit, const Scene& scene, int depth, TraceContext* ctx) {
+    Vec3 value;
+    if (ctx->irradiance->lookup(hit.point, hit.normal, value, static_cast<Real>(depth + 1))) {
+        if (ctx->stats) ctx->stats->irradianceReused++;
+        return value;
+    }
+    if (ctx->stats) ctx->stats->irradianceComputed++;
+    return sampleHemisphere<F>(hit.point, hit.normal, depth, scene, *ctx->irradiance, ctx).value;
+}
+
 // Iluminação local (Phong)
-Vec3 calculateLocalIllumination(const HitInfo& hit, const Scene& scene, const Ray& ray) {
+template<unsigned F>
+Vec3 calculateLocalIllumination(const HitInfo& hit, const Scene& scene, const Ray& ray,
+                                TraceContext* ctx, GBufferNode* node, int depth) {
     const Object& obj = scene.objects[hit.objectIdx];
     const Pigment& pigment = scene.pigments[obj.pigmentIdx];
     const Finish& finish = scene.finishes[obj.finishIdx];
     
-    Vec3 baseColor = getPigmentColor(pigment, hit.point);
-    Vec3 viewDir = (ray.origin - hit.point).normalize();
-    Vec3 color(0, 0, 0);
+    Vec3 baseColor = baseColorAt<F>(pigment, hit.point);
+    Vec3 viewDir;
+    if constexpr ((F & SHADE_FAST) != 0) viewDir = fastNormalize(ray.origin - hit.point);
+    else viewDir = (ray.origin - hit.point).normalize();
+    Vec3 color = ambientTerm(baseColor, scene, finish);
+    if (ctx && ctx->irradiance && finish.kd > 0) {
+        color = color + baseColor.mul(indirectDiffuse<F>(hit, scene, depth, ctx)) * finish.kd;
+    }
     
-    // Luz ambiente (primeira luz)
-    if (!scene.lights.empty()) {
-        color = calculateAmbient(baseColor, scene.lights[0], finish.ka);
+    if (node) {
+        node->baseColor = baseColor;
+        node->viewDir = viewDir;
     }
     
-    // Luzes pontuais (restantes)
+    // Luzes pontuais (a primeira é a ambiente); direção e distância
+    // calculadas uma vez para a sombra e para o sombreamento
     for (size_t i = 1; i < scene.lights.size(); i++) {
         const Light& light = scene.lights[i];
+        LightSample toLight = sampleLight(light, hit.point);
         
-        if (isInShadow(hit.point, hit.normal, light, scene)) continue;
-        
-        Vec3 lightDir = (light.position - hit.point).normalize();
-        double lightDist = (light.position - hit.point).length();
-        double atten = calculateAttenuation(light, lightDist);
+        if (isInShadow(hit.point, hit.normal, occluderSlot(i, depth), toLight, scene, ctx)) {
+            if (node) node->shadowMask |= uint64_t(1) << i;
+            continue;
+        }
         
-        color = color + calculateDiffuse(baseColor, hit.normal, lightDir, light, finish.kd, atten);
-        color = color + calculateSpecular(hit.normal, lightDir, viewDir, light, finish.ks, finish.alpha, atten);
+        color = color + lightTerm<F>(baseColor, hit.normal, viewDir, light, toLight, finish);
     }
     
-    return color.clamp();
+    return color;
 }
 
 // Calcular reflexão
+template<unsigned F>
 Vec3 calculateReflection(const HitInfo& hit, const Scene& scene, const Ray& ray, 
-                         const Finish& finish, int depth) {
+                         const Finish& finish, int depth, TraceContext* ctx) {
     if (finish.kr <= 0 || depth >= MAX_DEPTH) return Vec3(0, 0, 0);
     
     Vec3 reflectDir = ray.direction.reflect(hit.normal);
-    Ray reflectRay(hit.point + hit.normal * SHADOW_BIAS, reflectDir);
+    Ray reflectRay(offsetOrigin(hit.point, hit.normal), reflectDir);
+    if (ctx && ctx->stats) ctx->stats->reflectionRays++;
     
-    return traceRay(reflectRay, scene, depth + 1) * finish.kr;
+    return trace<F>(reflectRay, scene, depth + 1, ctx) * finish.kr;
 }
 
 // Calcular refração
+template<unsigned F>
 Vec3 calculateRefraction(const HitInfo& hit, const Scene& scene, const Ray& ray,
-                         const Finish& finish, int depth) {
+                         const Finish& finish, int depth, TraceContext* ctx) {
     if (finish.kt <= 0 || depth >= MAX_DEPTH) return Vec3(0, 0, 0);
     
     Vec3 refractDir;
@@ -120,33 +333,184 @@ Vec3 calculateRefraction(const HitInfo& hit, const Scene& scene, const Ray& ray,
         return Vec3(0, 0, 0);
     }
     
-    Ray refractRay(hit.point - hit.normal * SHADOW_BIAS, refractDir);
-    return traceRay(refractRay, scene, depth + 1) * finish.kt;
+    Ray refractRay(offsetOrigin(hit.point, -hit.normal), refractDir);
+    if (ctx && ctx->stats) ctx->stats->refractionRays++;
+    return trace<F>(refractRay, scene, depth + 1, ctx) * finish.kt;
 }
 
-// Shader completo
-Vec3 shade(const HitInfo& hit, const Scene& scene, const Ray& ray, int depth) {
+// Shader completo. Recursos ausentes de F somem em tempo de compilação: sem
+// testes de kr/kt nem do tipo de pigmento no caso comum
+template<unsigned F>
+Vec3 shade(const HitInfo& hit, const Scene& scene, const Ray& ray, int depth, TraceContext* ctx) {
     const Finish& finish = scene.finishes[scene.objects[hit.objectIdx].finishIdx];
     
-    Vec3 color = calculateLocalIllumination(hit, scene, ray);
-    color = color + calculateReflection(hit, scene, ray, finish, depth);
-    color = color + calculateRefraction(hit, scene, ray, finish, depth);
+    // G-buffer: um nó por ponto de sombreamento, ligado aos raios filhos
+    GBufferPixel* gbuf = ctx ? ctx->gbuffer : nullptr;
+    int nodeIdx = GNODE_NONE;
+    if (gbuf) {
+        nodeIdx = static_cast<int>(gbuf->nodes.size());
+        gbuf->nodes.emplace_back();
+        gbuf->nodes.back().point = hit.point;
+        gbuf->nodes.back().normal = hit.normal;
+        gbuf->nodes.back().objectIdx = hit.objectIdx;
+    }
+    
+    Vec3 color = calculateLocalIllumination<F>(hit, scene, ray, ctx,
+                                               gbuf ? &gbuf->nodes.back() : nullptr, depth);
     
-    return color.clamp();
+    if (gbuf) gbuf->lastNode = GNODE_NONE;
+    if constexpr ((F & SHADE_REFLECTION) != 0) {
+        color = color + calculateReflection<F>(hit, scene, ray, finish, depth, ctx);
+    }
+    if (gbuf) {
+        gbuf->nodes[nodeIdx].reflectChild = gbuf->lastNode;
+        gbuf->lastNode = GNODE_NONE;
+    }
+    
+    if constexpr ((F & SHADE_REFRACTION) != 0) {
+        color = color + calculateRefraction<F>(hit, scene, ray, finish, depth, ctx);
+    }
+    if (gbuf) {
+        gbuf->nodes[nodeIdx].refractChild = gbuf->lastNode;
+        gbuf->lastNode = nodeIdx;
+    }
+    
+    // Sem clamp: a faixa dinâmica é preservada até o mapeamento de tons
+    return color;
 }
 
-} // namespace anônimo
+// Registrar albedo, normal e profundidade do impacto primário
+void recordAux(const HitInfo& hit, const Scene& scene, const Ray& ray, TraceContext& ctx) {
+    if (!hit.hit) {
+        ctx.auxAlbedo = ctx.auxAlbedo + backgroundColor();
+        ctx.auxDepth += RAY_FAR;
+        return;
+    }
+    
+    const Object& obj = scene.objects[hit.objectIdx];
+    ctx.auxAlbedo = ctx.auxAlbedo + getPigmentColor(scene.pigments[obj.pigmentIdx], hit.point);
+    ctx.auxNormal = ctx.auxNormal + hit.normal;
+    ctx.auxDepth += (hit.point - ray.origin).length();
+}
 
-// Função principal de ray tracing
-Vec3 traceRay(const Ray& ray, const Scene& scene, int depth) {
-    if (depth > MAX_DEPTH) return Vec3(0, 0, 0);
+// Ray tracing na variante F (recursão permanece na mesma variante)
+template<unsigned F>
+Vec3 trace(const Ray& ray, const Scene& scene, int depth, TraceContext* ctx) {
+    if (depth > MAX_DEPTH) {
+        if (ctx && ctx->gbuffer) ctx->gbuffer->lastNode = GNODE_NONE;
+        return Vec3(0, 0, 0);
+    }
     
-    HitInfo hit = findClosestHit(ray, scene);
+    RenderStats* stats = ctx ? ctx->stats : nullptr;
+    if (stats) {
+        if (depth == 0) stats->primaryRays++;
+        stats->depthSum += depth;
+    }
+    
+    HitInfo hit;
+    if (depth == 0 && ctx && ctx->primaryCandidates) {
+        if (stats) stats->binnedRays++;
+        hit = findClosestHit(ray, scene, *ctx->primaryCandidates, stats);
+    } else {
+        hit = findClosestHit(ray, scene, stats);
+    }
+    
+    if (ctx && ctx->recording()) {
+        if (hit.hit) {
+            ctx->recordHit(hit.objectIdx);
+            ctx->recordHitPoint(depth, hit.point);
+        } else {
+            ctx->recordEscape(ray.origin, ray.at(RAY_FAR));
+        }
+    }
+    if (ctx && depth == 0) {
+        ctx->primaryObject = hit.objectIdx;
+        if (ctx->captureAux) recordAux(hit, scene, ray, *ctx);
+    }
     
     if (hit.hit) {
-        return shade(hit, scene, ray, depth);
+        return shade<F>(hit, scene, ray, depth, ctx);
     }
     
-    // Cor de fundo
-    return Vec3(0.1, 0.1, 0.1);
+    if (ctx && ctx->gbuffer) ctx->gbuffer->lastNode = GNODE_BACKGROUND;
+    return backgroundColor();
+}
+
+// Pontos difusos do raio e dos raios especulares que trace() lançaria a partir
+// dele (mesma ordem e profundidade)
+void gatherPath(const Ray& ray, const Scene& scene, int depth, std::vector<ShadingPoint>& out) {
+    if (depth > MAX_DEPTH) return;
+    
+    HitInfo hit = findClosestHit(ray, scene);
+    if (!hit.hit) return;
+    
+    const Finish& finish = scene.finishes[scene.objects[hit.objectIdx].finishIdx];
+    if (finish.kd > 0) out.push_back(ShadingPoint{ hit.point, hit.normal, depth });
+    if (depth >= MAX_DEPTH) return;
+    
+    if (finish.kr > 0) {
+        gatherPath(Ray(offsetOrigin(hit.point, hit.normal), ray.direction.reflect(hit.normal)),
+                   scene, depth + 1, out);
+    }
+    Vec3 refractDir;
+    if (finish.kt > 0 && refract(ray.direction, hit.normal, finish.ior, refractDir)) {
+        gatherPath(Ray(offsetOrigin(hit.point, -hit.normal), refractDir), scene, depth + 1, out);
+    }
+}
+
+} // namespace anônimo
+
+// Tabela de variantes, indexada pela máscara de ShadeFeature
+using TraceFunc = Vec3(*)(const Ray&, const Scene&, int, TraceContext*);
+static const TraceFunc traceVariants[] = {
+    trace<0>, trace<1>, trace<2>,  trace<3>,  trace<4>,  trace<5>,  trace<6>,  trace<7>,
+    trace<8>, trace<9>, trace<10>, trace<11>, trace<12>, trace<13>, trace<14>, trace<15>
+};
+
+// Função principal de ray tracing: escolhe a variante pelos recursos da cena
+// e pelo modo rápido do contexto
+Vec3 traceRay(const Ray& ray, const Scene& scene, int depth, TraceContext* ctx) {
+    unsigned variant = scene.features & SHADE_ALL;
+    if (ctx && ctx->fastMath) variant |= SHADE_FAST;
+    return traceVariants[variant](ray, scene, depth, ctx);
+}
+
+using SampleFunc = IrradianceRecord(*)(const Vec3&, const Vec3&, int, const Scene&,
+                                       const IrradianceCache&, TraceContext*);
+static const SampleFunc sampleVariants[] = {
+    sampleHemisphere<0>, sampleHemisphere<1>, sampleHemisphere<2>,  sampleHemisphere<3>,
+    sampleHemisphere<4>, sampleHemisphere<5>, sampleHemisphere<6>,  sampleHemisphere<7>,
+    sampleHemisphere<8>, sampleHemisphere<9>, sampleHemisphere<10>, sampleHemisphere<11>,
+    sampleHemisphere<12>, sampleHemisphere<13>, sampleHemisphere<14>, sampleHemisphere<15>
+};
+
+IrradianceRecord sampleIrradiance(const ShadingPoint& at, const Scene& scene,
+                                  const IrradianceCache& cache, TraceContext* ctx) {
+    unsigned variant = scene.features & SHADE_ALL;
+    if (ctx && ctx->fastMath) variant |= SHADE_FAST;
+    return sampleVariants[variant](at.point, at.normal, at.depth, scene, cache, ctx);
+}
+
+void gatherShadingPoints(const Ray& ray, const Scene& scene, std::vector<ShadingPoint>& out) {
+    gatherPath(ray, scene, 0, out);
+}
+
+std::string shadeVariantName(unsigned features) {
+    std::string suffix = (features & SHADE_FAST) ? " (rápida)" : "";
+    if ((features & SHADE_ALL) == 0) return "básica" + suffix;
+    std::string name;
+    if (features & SHADE_REFLECTION) name += "reflexão";
+    if (features & SHADE_REFRACTION) name += std::string(name.empty() ? "" : "+") + "refração";
+    if (features & SHADE_PATTERN) name += std::string(name.empty() ? "" : "+") + "padrões";
+    return name + suffix;
+}
+
+Vec3 ambientTerm(const Vec3& baseColor, const Scene& scene, const Finish& finish) {
+    if (scene.lights.empty()) return Vec3(0, 0, 0);
+    return calculateAmbient(baseColor, scene.lights[0], finish.ka);
+}
+
+Vec3 directTerm(const Vec3& baseColor, const Vec3& point, const Vec3& normal,
+                const Vec3& viewDir, const Light& light, const Finish& finish) {
+    return lightTerm<0>(baseColor, normal, viewDir, light, sampleLight(light, point), finish);
 }
\ No newline at end of file
@@ -0,0 +1,152 @@
+// src/stats.cpp
+#include "../include/stats.hpp"
+#include <iomanip>
+
+namespace {
+
+double raysPerSecond(const RenderStats& stats, const PhaseTimings& timings) {
+    // Raios do hemisfério também saem da pré-passada
+    double ms = timings.renderMs + timings.giMs;
+    return ms > 0 ? stats.totalRays() / (ms / 1000.0) : 0.0;
+}
+
+} // namespace anônimo
+
+void RenderStats::merge(const RenderStats& other) {
+    primaryRays += other.primaryRays;
+    shadowRays += other.shadowRays;
+    reflectionRays += other.reflectionRays;
+    refractionRays += other.refractionRays;
+    binnedRays += other.binnedRays;
+    shadowCacheHits += other.shadowCacheHits;
+    shadowCacheMisses += other.shadowCacheMisses;
+    irradianceRays += other.irradianceRays;
+    irradianceRecords += other.irradianceRecords;
+    irradianceReused += other.irradianceReused;
+    irradianceComputed += other.irradianceComputed;
+    depthSum += other.depthSum;
+    bvhNodes += other.bvhNodes;
+    for (int i = 0; i < OBJECT_TYPE_COUNT; i++) {
+        tests[i] += other.tests[i];
+        hits[i] += other.hits[i];
+    }
+}
+
+const char* objectTypeName(ObjectType type) {
+    switch (type) {
+        case SPHERE:     return "sphere";
+        case POLYHEDRON: return "polyhedron";
+        case QUADRIC:    return "quadric";
+        case TRIANGLE:   return "triangle";
+        case CYLINDER:   return "cylinder";
+        case CONE:       return "cone";
+    }
+    return "unknown";
+}
+
+const char* quadricClassName(QuadricClass shape) {
+    switch (shape) {
+        case QUADRIC_GENERAL:     return "general";
+        case QUADRIC_SPHERE:      return "sphere";
+        case QUADRIC_ELLIPSOID:   return "ellipsoid";
+        case QUADRIC_CYLINDER:    return "cylinder";
+        case QUADRIC_CONE:        return "cone";
+        case QUADRIC_PARABOLOID:  return "paraboloid";
+        case QUADRIC_HYPERBOLOID: return "hyperboloid";
+        case QUADRIC_PLANE:       return "plane";
+        case QUADRIC_OTHER:       return "other";
+        case QUADRIC_CLASS_COUNT: break;
+    }
+    return "unknown";
+}
+
+void printStats(std::ostream& out, const RenderStats& stats, const PhaseTimings& timings,
+                const Scene& scene) {
+    out << "=== Estatísticas ===" << std::endl;
+    out << std::fixed << std::setprecision(2);
+    out << "Tempo (ms): carga " << timings.loadMs << ", BVH " << timings.bvhMs
+        << ", câmera " << timings.cameraMs;
+    if (timings.giMs > 0) out << ", irradiância " << timings.giMs;
+    out << ", render " << timings.renderMs
+        << ", gravação " << timings.saveMs << std::endl;
+    const LoadTimings& load = timings.load;
+    out << "Carga (ms): leitura " << load.parseMs << ", texturas " << load.textureMs
+        << " em " << load.textures << " arquivo(s) (espera " << load.textureWaitMs
+        << "), preparo " << load.prepareMs << std::endl;
+    out << "Raios: " << stats.primaryRays << " primários, " << stats.shadowRays << " de sombra, "
+        << stats.reflectionRays << " de reflexão, " << stats.refractionRays << " de refração"
+        << std::endl;
+    out << "Raios por segundo: " << std::setprecision(0) << raysPerSecond(stats, timings)
+        << std::setprecision(2) << std::endl;
+    if (stats.shadowRays) {
+        out << "Cache de oclusores: " << stats.shadowCacheHits << " acertos, "
+            << stats.shadowCacheMisses << " falhas ("
+            << 100.0 * stats.shadowCacheHits / stats.shadowRays << "% de acerto)" << std::endl;
+    }
+    if (stats.irradianceRecords || stats.irradianceReused || stats.irradianceComputed) {
+        out << "Cache de irradiância: " << stats.irradianceRecords << " registros, "
+            << stats.irradianceReused << " pontos reutilizados, " << stats.irradianceComputed
+            << " amostrados na hora, " << stats.irradianceRays << " raios de hemisfério" << std::endl;
+    }
+    if (stats.binnedRays) {
+        out << "Primários por lista do tile: " << stats.binnedRays << std::endl;
+    }
+    out << "Profundidade média: " << stats.averageDepth() << std::endl;
+    out << "Nós da BVH visitados: " << stats.bvhNodes << std::endl;
+    for (int i = 0; i < OBJECT_TYPE_COUNT; i++) {
+        if (stats.tests[i] == 0) continue;
+        out << "Interseções " << objectTypeName(static_cast<ObjectType>(i)) << ": "
+            << stats.tests[i] << " testes, " << stats.hits[i] << " acertos" << std::endl;
+    }
+    for (int i = 0; i < QUADRIC_CLASS_COUNT; i++) {
+        if (scene.quadricClasses[i] == 0) continue;
+        out << "Quádricas " << quadricClassName(static_cast<QuadricClass>(i)) << ": "
+            << scene.quadricClasses[i];
+        if (scene.quadricRewritten[i]) out << " (" << scene.quadricRewritten[i] << " como tipo nativo)";
+        out << std::endl;
+    }
+    out.unsetf(std::ios::fixed);
+}
+
+void writeStatsJSON(std::ostream& out, const RenderStats& stats, const PhaseTimings& timings,
+                    const Scene& scene, int width, int height, int samples, int threads) {
+    out << std::fixed << std::setprecision(3);
+    out << "{\"width\":" << width << ",\"height\":" << height
+        << ",\"samples\":" << samples << ",\"threads\":" << threads
+        << ",\"timings_ms\":{\"load\":" << timings.loadMs << ",\"bvh\":" << timings.bvhMs
+        << ",\"camera\":" << timings.cameraMs << ",\"irradiance\":" << timings.giMs
+        << ",\"render\":" << timings.renderMs
+        << ",\"save\":" << timings.saveMs << ",\"total\":" << timings.totalMs() << "}"
+        << ",\"load_stages_ms\":{\"parse\":" << timings.load.parseMs
+        << ",\"textures\":" << timings.load.textureMs
+        << ",\"texture_wait\":" << timings.load.textureWaitMs
+        << ",\"prepare\":" << timings.load.prepareMs
+        << ",\"texture_count\":" << timings.load.textures << "}"
+        << ",\"rays\":{\"primary\":" << stats.primaryRays << ",\"shadow\":" << stats.shadowRays
+        << ",\"reflection\":" << stats.reflectionRays << ",\"refraction\":" << stats.refractionRays
+        << ",\"binned_primary\":" << stats.binnedRays
+        << ",\"irradiance\":" << stats.irradianceRays
+        << ",\"total\":" << stats.totalRays()
+        << ",\"per_second\":" << raysPerSecond(stats, timings) << "}"
+        << ",\"average_depth\":" << stats.averageDepth()
+        << ",\"bvh_nodes\":" << stats.bvhNodes
+        << ",\"shadow_cache\":{\"hits\":" << stats.shadowCacheHits
+        << ",\"misses\":" << stats.shadowCacheMisses << "}"
+        << ",\"irradiance_cache\":{\"records\":" << stats.irradianceRecords
+        << ",\"reused\":" << stats.irradianceReused
+        << ",\"computed\":" << stats.irradianceComputed << "}"
+        << ",\"intersections\":{";
+    for (int i = 0; i < OBJECT_TYPE_COUNT; i++) {
+        if (i > 0) out << ",";
+        out << "\"" << objectTypeName(static_cast<ObjectType>(i)) << "\":{\"tests\":"
+            << stats.tests[i] << ",\"hits\":" << stats.hits[i] << "}";
+    }
+    out << "},\"quadrics\":{";
+    for (int i = 0; i < QUADRIC_CLASS_COUNT; i++) {
+        if (i > 0) out << ",";
+        out << "\"" << quadricClassName(static_cast<QuadricClass>(i)) << "\":{\"count\":"
+            << scene.quadricClasses[i] << ",\"rewritten\":" << scene.quadricRewritten[i] << "}";
+    }
+    out << "}}" << std::endl;
+    out.unsetf(std::ios::fixed);
+}
@@ -0,0 +1,120 @@
+// src/threadpool.cpp
+#include "../include/threadpool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threads) : stopping(false) {
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+        if (threads <= 0) threads = 1;
+    }
+    
+    // A thread chamadora também trabalha em parallelFor()
+    for (int i = 0; i < threads - 1; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    if (workers.empty()) {
+        task();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    available.notify_one();
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& body) {
+    if (count <= 0) return;
+    
+    // Estado compartilhado: ajudantes atrasados encontram o contador esgotado
+    struct Job {
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        int count = 0;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto job = std::make_shared<Job>();
+    job->count = count;
+    
+    auto run = [job, &body] {
+        int i;
+        while ((i = job->next.fetch_add(1)) < job->count) {
+            body(i);
+            if (job->done.fetch_add(1) + 1 == job->count) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->finished.notify_all();
+            }
+        }
+    };
+    
+    int helpers = std::min(count - 1, size());
+    for (int h = 0; h < helpers; h++) submit(run);
+    
+    run();
+    
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->finished.wait(lock, [&] { return job->done.load() == job->count; });
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+TaskGroup::TaskGroup(ThreadPool& p) : pool(p), state(std::make_shared<State>()) {}
+
+void TaskGroup::execute(Task& task, State& state) {
+    // Quem pegar a tarefa primeiro (thread do pool ou wait()) a executa
+    if (task.claimed.exchange(true)) return;
+    task.body();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.done++;
+    state.finished.notify_all();
+}
+
+void TaskGroup::run(std::function<void()> body) {
+    auto task = std::make_shared<Task>();
+    task->body = std::move(body);
+    tasks.push_back(task);
+    
+    std::shared_ptr<State> shared = state;
+    pool.submit([task, shared] { execute(*task, *shared); });
+}
+
+void TaskGroup::wait() {
+    for (auto& task : tasks) execute(*task, *state);
+    
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&] { return state->done == static_cast<int>(tasks.size()); });
+    lock.unlock();
+    
+    tasks.clear();
+    state->done = 0;
+}
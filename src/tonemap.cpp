@@ -0,0 +1,41 @@
+// src/tonemap.cpp
+#include "../include/tonemap.hpp"
+#include <cmath>
+
+namespace {
+
+// Ajuste de Narkowicz para a curva ACES
+inline double aces(double x) {
+    return (x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14);
+}
+
+} // namespace anônimo
+
+bool parseToneMap(const std::string& name, ToneMap& op) {
+    if (name == "clamp")    { op = TONEMAP_CLAMP;    return true; }
+    if (name == "reinhard") { op = TONEMAP_REINHARD; return true; }
+    if (name == "aces")     { op = TONEMAP_ACES;     return true; }
+    return false;
+}
+
+Vec3 toneMap(const Vec3& color, ToneMap op, double gamma) {
+    Vec3 c = color.clamp(0.0, 1e30);
+
+    switch (op) {
+        case TONEMAP_CLAMP:
+            break;
+        case TONEMAP_REINHARD:
+            c = Vec3(c.x / (1.0 + c.x), c.y / (1.0 + c.y), c.z / (1.0 + c.z));
+            break;
+        case TONEMAP_ACES:
+            c = Vec3(aces(c.x), aces(c.y), aces(c.z));
+            break;
+    }
+
+    c = c.clamp();
+    if (gamma != 1.0) {
+        double inv = 1.0 / gamma;
+        c = Vec3(std::pow(c.x, inv), std::pow(c.y, inv), std::pow(c.z, inv));
+    }
+    return c;
+}
@@ -0,0 +1,127 @@
+// src/trace.cpp
+#include "../include/trace.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct TraceEvent {
+    const char* category;
+    const char* name;
+    const char* arg0;
+    const char* arg1;
+    int value0, value1;
+    int64_t start, end;
+};
+
+// Eventos de uma thread: só ela escreve, writeTrace() lê com o pool ocioso
+struct ThreadTrace {
+    int id = 0;
+    std::vector<TraceEvent> events;
+};
+
+// Capacidade inicial: um quadro 1080p em tiles de 16 sem realocar
+constexpr size_t INITIAL_EVENTS = 16384;
+
+std::chrono::steady_clock::time_point epoch;
+
+// Buffers de todas as threads que já gravaram; sobrevivem às threads
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadTrace>> registry;
+
+thread_local ThreadTrace* local = nullptr;
+
+ThreadTrace& threadTrace() {
+    if (!local) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::make_unique<ThreadTrace>());
+        local = registry.back().get();
+        local->id = static_cast<int>(registry.size()) - 1;
+        local->events.reserve(INITIAL_EVENTS);
+    }
+    return *local;
+}
+
+// Microssegundos com três casas (o formato aceita frações)
+void writeMicros(std::ostream& out, int64_t ns) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%lld.%03lld",
+                  static_cast<long long>(ns / 1000), static_cast<long long>(ns % 1000));
+    out << buffer;
+}
+
+} // namespace anônimo
+
+namespace trace_detail {
+
+std::atomic<bool> enabled(false);
+
+int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - epoch).count();
+}
+
+void record(const char* category, const char* name, int64_t start, int64_t end,
+            const char* arg0, int value0, const char* arg1, int value1) {
+    threadTrace().events.push_back(
+        TraceEvent{ category, name, arg0, arg1, value0, value1, start, end });
+}
+
+} // namespace trace_detail
+
+void traceEnable() {
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (auto& thread : registry) thread->events.clear();
+    }
+    epoch = std::chrono::steady_clock::now();
+    threadTrace();   // A thread que liga a gravação é a primeira da lista
+    trace_detail::enabled.store(true);
+}
+
+bool writeTrace(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Erro ao criar arquivo: " << filename << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+            "\"args\":{\"name\":\"ray_tracer\"}}";
+
+    // Nome e ordem das linhas: a thread principal primeiro, depois o pool
+    for (const auto& thread : registry) {
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->id
+             << ",\"args\":{\"name\":\"";
+        if (thread->id == 0) file << "principal";
+        else file << "thread " << thread->id;
+        file << "\"}},\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+             << thread->id << ",\"args\":{\"sort_index\":" << thread->id << "}}";
+    }
+
+    // Intervalos completos ("X"); o visualizador ordena e aninha pelo tempo
+    for (const auto& thread : registry) {
+        for (const TraceEvent& e : thread->events) {
+            file << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category
+                 << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->id << ",\"ts\":";
+            writeMicros(file, e.start);
+            file << ",\"dur\":";
+            writeMicros(file, e.end - e.start);
+            if (e.arg0) {
+                file << ",\"args\":{\"" << e.arg0 << "\":" << e.value0;
+                if (e.arg1) file << ",\"" << e.arg1 << "\":" << e.value1;
+                file << "}";
+            }
+            file << "}";
+        }
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,392 @@
+// testes/golden.cpp
+// Teste de regressão por imagens de referência: renderiza cada cena com
+// semente fixa chamando o executável e compara com testes/golden/<cena>.ppm
+// por PSNR e SSIM. Também compara duas configurações do renderizador entre si
+// (rápida contra referência) sem imagens armazenadas, ou mede o ganho de PSNR
+// de uma opção (--denoise) sobre a mesma renderização sem ela.
+#include "../include/scene.hpp"
+#include "../include/loader.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+#ifdef _WIN32
+const char* QUIET = " > NUL 2>&1";
+#else
+const char* QUIET = " > /dev/null 2>&1";
+#endif
+
+struct Options {
+    std::string binary = "bin/ray_tracer";
+    std::string args;                  // Flags extras da configuração testada
+    std::string referenceBinary;       // Modo ao vivo: executável de referência
+    std::string referenceArgs;
+    int referenceSamples = 0;          // Amostras da referência ao vivo (0: as mesmas)
+    std::string baselineArgs;          // Ganho: flags da renderização sem a opção testada
+    double minGain = 0.0;              // Ganho mínimo de PSNR sobre ela (dB)
+    bool gain = false;
+    bool live = false;
+    bool update = false;
+    std::string goldenDir = "testes/golden";
+    std::string outDir = "resultados/golden";
+    int width = 160, height = 120, samples = 4;
+    unsigned long seed = 1;
+    double minPSNR = 40.0;
+    double minSSIM = 0.98;
+    int maxError = -1;                 // Maior diferença por canal em níveis de 8 bits (-1: livre)
+};
+
+// Imagem 8 bits convertida para [0, 1]
+struct Image {
+    int width = 0, height = 0;
+    std::vector<Vec3> pixels;
+};
+
+std::string sceneName(const std::string& filename) {
+    size_t slash = filename.find_last_of("/\\");
+    std::string base = slash == std::string::npos ? filename : filename.substr(slash + 1);
+    size_t dot = base.find_last_of('.');
+    return dot == std::string::npos ? base : base.substr(0, dot);
+}
+
+bool readImage(const std::string& filename, Image& image) {
+    Pigment pigment;
+    if (!loadPPM(filename, pigment)) return false;
+    image.width = pigment.textureWidth;
+    image.height = pigment.textureHeight;
+    image.pixels.swap(pigment.textureData);
+    return true;
+}
+
+// PPM binário (P6): as referências ocupam um quarto do P3 gerado pelo renderizador
+bool writeImage(const std::string& filename, const Image& image) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) return false;
+    file << "P6\n" << image.width << " " << image.height << "\n255\n";
+    for (const Vec3& p : image.pixels) {
+        unsigned char rgb[3] = {
+            static_cast<unsigned char>(std::clamp(p.x, 0.0, 1.0) * 255.0 + 0.5),
+            static_cast<unsigned char>(std::clamp(p.y, 0.0, 1.0) * 255.0 + 0.5),
+            static_cast<unsigned char>(std::clamp(p.z, 0.0, 1.0) * 255.0 + 0.5)
+        };
+        file.write(reinterpret_cast<const char*>(rgb), 3);
+    }
+    return static_cast<bool>(file);
+}
+
+// Entrada ausente (cena ou textura que ela usa): o caminho que falta, ou vazio.
+// Só isso justifica ignorar a cena; qualquer outra falha do renderizador é falha.
+std::string missingInput(const std::string& scene) {
+    std::error_code ec;
+    if (!std::filesystem::exists(scene, ec)) return scene;
+
+    // Carga silenciosa: as mensagens do loader sobre a textura ausente sairiam
+    // misturadas ao relatório
+    Scene parsed;
+    std::streambuf* previous = std::cerr.rdbuf(nullptr);
+    bool loaded = loadScene(scene, parsed);
+    std::cerr.rdbuf(previous);
+    if (loaded) return "";
+
+    for (const Pigment& pigment : parsed.pigments) {
+        if (pigment.type == TEXMAP && !std::filesystem::exists(pigment.texturePath, ec)) {
+            return pigment.texturePath;
+        }
+    }
+    return "";
+}
+
+// Executar o renderizador; false se ele falhar
+bool render(const std::string& binary, const std::string& args, const std::string& scene,
+            const std::string& output, const Options& opt, int samples, unsigned long seed) {
+    std::string cmd = "\"" + binary + "\" \"" + scene + "\" \"" + output + "\" " +
+                      std::to_string(opt.width) + " " + std::to_string(opt.height) + " " +
+                      std::to_string(samples) + " --seed " + std::to_string(seed);
+    if (!args.empty()) cmd += " " + args;
+    return std::system((cmd + QUIET).c_str()) == 0;
+}
+
+double psnr(const Image& a, const Image& b) {
+    double mse = 0.0;
+    for (size_t i = 0; i < a.pixels.size(); i++) {
+        Vec3 d = a.pixels[i] - b.pixels[i];
+        mse += d.dot(d);
+    }
+    mse /= 3.0 * a.pixels.size();
+    return mse > 0.0 ? 10.0 * std::log10(1.0 / mse) : std::numeric_limits<double>::infinity();
+}
+
+// Maior diferença absoluta entre canais, em níveis de 8 bits
+int maxLevelError(const Image& a, const Image& b) {
+    auto level = [](Real v) { return static_cast<int>(std::lround(v * 255.0)); };
+    int worst = 0;
+    for (size_t i = 0; i < a.pixels.size(); i++) {
+        const Vec3& p = a.pixels[i];
+        const Vec3& q = b.pixels[i];
+        worst = std::max({ worst, std::abs(level(p.x) - level(q.x)),
+                           std::abs(level(p.y) - level(q.y)), std::abs(level(p.z) - level(q.z)) });
+    }
+    return worst;
+}
+
+// SSIM médio da luminância em janelas 8x8 com passo 4
+double ssim(const Image& a, const Image& b) {
+    const double C1 = 0.01 * 0.01, C2 = 0.03 * 0.03;
+    const int WINDOW = 8, STEP = 4;
+
+    auto luma = [](const Vec3& c) { return 0.2126 * c.x + 0.7152 * c.y + 0.0722 * c.z; };
+
+    double total = 0.0;
+    int windows = 0;
+    for (int y0 = 0; y0 + WINDOW <= a.height; y0 += STEP) {
+        for (int x0 = 0; x0 + WINDOW <= a.width; x0 += STEP) {
+            double sa = 0, sb = 0, saa = 0, sbb = 0, sab = 0;
+            for (int y = y0; y < y0 + WINDOW; y++) {
+                for (int x = x0; x < x0 + WINDOW; x++) {
+                    double la = luma(a.pixels[y * a.width + x]);
+                    double lb = luma(b.pixels[y * a.width + x]);
+                    sa += la; sb += lb;
+                    saa += la * la; sbb += lb * lb; sab += la * lb;
+                }
+            }
+            const double n = WINDOW * WINDOW;
+            double ma = sa / n, mb = sb / n;
+            double va = saa / n - ma * ma, vb = sbb / n - mb * mb, cov = sab / n - ma * mb;
+            total += ((2 * ma * mb + C1) * (2 * cov + C2)) /
+                     ((ma * ma + mb * mb + C1) * (va + vb + C2));
+            windows++;
+        }
+    }
+    return windows > 0 ? total / windows : 1.0;
+}
+
+// Diferença absoluta ampliada 8x: erros pequenos ficam visíveis
+Image diffImage(const Image& a, const Image& b) {
+    Image diff;
+    diff.width = a.width;
+    diff.height = a.height;
+    diff.pixels.resize(a.pixels.size());
+    for (size_t i = 0; i < a.pixels.size(); i++) {
+        Vec3 d = a.pixels[i] - b.pixels[i];
+        diff.pixels[i] = Vec3(std::fabs(d.x), std::fabs(d.y), std::fabs(d.z)) * 8.0;
+    }
+    return diff;
+}
+
+enum Outcome { PASSED, FAILED, SKIPPED };
+
+Outcome checkScene(const std::string& scene, const Options& opt) {
+    const std::string name = sceneName(scene);
+    const std::string current = opt.outDir + "/" + name + "_atual.ppm";
+    std::cout << std::left << std::setw(10) << name << std::right;
+
+    std::string missing = missingInput(scene);
+    if (!missing.empty()) {
+        std::cout << " ignorada (" << missing << " não encontrado)" << std::endl;
+        return SKIPPED;
+    }
+
+    if (!render(opt.binary, opt.args, scene, current, opt, opt.samples, opt.seed)) {
+        std::cout << " FALHOU (o renderizador terminou com erro)" << std::endl;
+        return FAILED;
+    }
+
+    Image candidate;
+    if (!readImage(current, candidate)) return FAILED;
+
+    // Referência armazenada, ou renderizada agora pela outra configuração
+    const std::string golden = opt.goldenDir + "/" + name + ".ppm";
+    std::string referenceFile = golden;
+    if (opt.live) {
+        // Com mais amostras, outra semente: as primeiras amostras não coincidem
+        // com as da imagem testada
+        referenceFile = opt.outDir + "/" + name + "_ref.ppm";
+        std::string binary = opt.referenceBinary.empty() ? opt.binary : opt.referenceBinary;
+        int samples = opt.referenceSamples > 0 ? opt.referenceSamples : opt.samples;
+        unsigned long seed = opt.referenceSamples > 0 ? opt.seed + 1 : opt.seed;
+        if (!render(binary, opt.referenceArgs, scene, referenceFile, opt, samples, seed)) {
+            std::cout << " falha ao renderizar a referência" << std::endl;
+            return FAILED;
+        }
+    }
+
+    if (opt.update) {
+        if (!writeImage(golden, candidate)) {
+            std::cout << " erro ao gravar " << golden << std::endl;
+            return FAILED;
+        }
+        std::cout << " referência atualizada" << std::endl;
+        return PASSED;
+    }
+
+    Image reference;
+    if (!readImage(referenceFile, reference)) {
+        std::cout << " sem referência (make golden-update)" << std::endl;
+        return FAILED;
+    }
+    if (reference.width != candidate.width || reference.height != candidate.height) {
+        std::cout << " tamanho difere da referência" << std::endl;
+        return FAILED;
+    }
+
+    double p = psnr(reference, candidate);
+    double s = ssim(reference, candidate);
+    bool ok = p >= opt.minPSNR && s >= opt.minSSIM;
+
+    std::cout << std::fixed << std::setprecision(2) << " PSNR " << std::setw(7) << p
+              << " dB  SSIM " << std::setprecision(5) << s;
+    std::cout.unsetf(std::ios::fixed);
+
+    if (opt.maxError >= 0) {
+        int worst = maxLevelError(reference, candidate);
+        std::cout << "  erro máx " << worst;
+        ok = ok && worst <= opt.maxError;
+    }
+
+    // Mesma renderização sem a opção testada, contra a mesma referência
+    if (opt.gain) {
+        const std::string baselineFile = opt.outDir + "/" + name + "_base.ppm";
+        Image baseline;
+        if (!render(opt.binary, opt.baselineArgs, scene, baselineFile, opt, opt.samples, opt.seed) ||
+            !readImage(baselineFile, baseline)) {
+            std::cout << "  falha ao renderizar a base" << std::endl;
+            return FAILED;
+        }
+        double gain = p - psnr(reference, baseline);
+        std::cout << std::fixed << std::setprecision(2) << "  ganho " << std::setw(6) << gain << " dB";
+        std::cout.unsetf(std::ios::fixed);
+        ok = ok && gain >= opt.minGain;
+    }
+
+    if (ok) {
+        std::cout << "  ok" << std::endl;
+        return PASSED;
+    }
+
+    const std::string diff = opt.outDir + "/" + name + "_diff.ppm";
+    writeImage(diff, diffImage(reference, candidate));
+    std::cout << "  FALHOU (diferença: " << diff << ")" << std::endl;
+    return FAILED;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Uso: " << program << " [opções] cena.in ..." << std::endl;
+    std::cerr << "  --bin <executável>      Renderizador testado (padrão: bin/ray_tracer)" << std::endl;
+    std::cerr << "  --args \"<flags>\"        Flags extras do renderizador testado" << std::endl;
+    std::cerr << "  --live                  Comparar com a referência renderizada agora" << std::endl;
+    std::cerr << "  --reference-bin <exe>   Executável de referência do modo ao vivo (padrão: --bin)" << std::endl;
+    std::cerr << "  --reference-args \"..\"   Flags da referência do modo ao vivo" << std::endl;
+    std::cerr << "  --reference-samples <n> Amostras da referência do modo ao vivo (padrão: --samples)" << std::endl;
+    std::cerr << "  --baseline-args \"..\"    Flags da base sem a opção testada (mede o ganho de PSNR)" << std::endl;
+    std::cerr << "  --min-gain <dB>         Ganho mínimo de PSNR sobre a base (padrão: 0)" << std::endl;
+    std::cerr << "  --update                Regravar as referências em testes/golden" << std::endl;
+    std::cerr << "  --golden <dir>          Diretório das referências" << std::endl;
+    std::cerr << "  --out <dir>             Imagens atuais e de diferença (padrão: resultados/golden)" << std::endl;
+    std::cerr << "  --size <L> <A>          Resolução (padrão: 160 120)" << std::endl;
+    std::cerr << "  --samples <n>           Amostras por pixel (padrão: 4)" << std::endl;
+    std::cerr << "  --seed <s>              Semente (padrão: 1)" << std::endl;
+    std::cerr << "  --psnr <dB>             PSNR mínimo (padrão: 40)" << std::endl;
+    std::cerr << "  --ssim <v>              SSIM mínimo (padrão: 0.98)" << std::endl;
+    std::cerr << "  --max-error <n>         Diferença máxima por canal, em níveis de 8 bits" << std::endl;
+}
+
+} // namespace anônimo
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    std::vector<std::string> scenes;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--bin" && i + 1 < argc) {
+            opt.binary = argv[++i];
+        } else if (arg == "--args" && i + 1 < argc) {
+            opt.args = argv[++i];
+        } else if (arg == "--live") {
+            opt.live = true;
+        } else if (arg == "--reference-bin" && i + 1 < argc) {
+            opt.referenceBinary = argv[++i];
+            opt.live = true;
+        } else if (arg == "--reference-args" && i + 1 < argc) {
+            opt.referenceArgs = argv[++i];
+            opt.live = true;
+        } else if (arg == "--reference-samples" && i + 1 < argc) {
+            opt.referenceSamples = std::atoi(argv[++i]);
+            opt.live = true;
+        } else if (arg == "--baseline-args" && i + 1 < argc) {
+            opt.baselineArgs = argv[++i];
+            opt.gain = true;
+        } else if (arg == "--min-gain" && i + 1 < argc) {
+            opt.minGain = std::atof(argv[++i]);
+            opt.gain = true;
+        } else if (arg == "--update") {
+            opt.update = true;
+        } else if (arg == "--golden" && i + 1 < argc) {
+            opt.goldenDir = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            opt.outDir = argv[++i];
+        } else if (arg == "--size" && i + 2 < argc) {
+            opt.width = std::atoi(argv[++i]);
+            opt.height = std::atoi(argv[++i]);
+        } else if (arg == "--samples" && i + 1 < argc) {
+            opt.samples = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            opt.seed = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--psnr" && i + 1 < argc) {
+            opt.minPSNR = std::atof(argv[++i]);
+        } else if (arg == "--ssim" && i + 1 < argc) {
+            opt.minSSIM = std::atof(argv[++i]);
+        } else if (arg == "--max-error" && i + 1 < argc) {
+            opt.maxError = std::atoi(argv[++i]);
+        } else if (arg[0] == '-') {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            scenes.push_back(arg);
+        }
+    }
+
+    if (scenes.empty() || opt.width <= 0 || opt.height <= 0 || opt.samples <= 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (opt.update && opt.live) {
+        std::cerr << "--update não combina com o modo ao vivo" << std::endl;
+        return 1;
+    }
+    if (opt.update && opt.gain) {
+        std::cerr << "--update não combina com a medida de ganho" << std::endl;
+        return 1;
+    }
+
+    if (opt.live) {
+        std::cout << "Comparando '" << opt.binary << " " << opt.args << "' com '"
+                  << (opt.referenceBinary.empty() ? opt.binary : opt.referenceBinary) << " "
+                  << opt.referenceArgs << "'" << std::endl;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(opt.outDir, ec);
+    if (opt.update) std::filesystem::create_directories(opt.goldenDir, ec);
+
+    int passed = 0, failed = 0, skipped = 0;
+    for (const std::string& scene : scenes) {
+        switch (checkScene(scene, opt)) {
+            case PASSED:  passed++;  break;
+            case FAILED:  failed++;  break;
+            case SKIPPED: skipped++; break;
+        }
+    }
+
+    std::cout << passed << " ok, " << failed << " falhas, " << skipped << " ignoradas" << std::endl;
+    return failed > 0 ? 1 : 0;
+}